@@ -1033,6 +1033,7 @@ Amr::writePlotFileDoit (std::string const& pltfile, bool regular)
         }
 
         if (AsyncOut::UseAsyncOut()) {
+            last_write_handle = AsyncOut::GetWriteHandle();
             break;
         } else {
             ParallelDescriptor::Barrier("Amr::writePlotFile::end");
@@ -1862,6 +1863,7 @@ Amr::checkPoint ()
     }
 
     if (AsyncOut::UseAsyncOut()) {
+        last_write_handle = AsyncOut::GetWriteHandle();
         break;
     } else {
         ParallelDescriptor::Barrier("Amr::checkPoint::end");
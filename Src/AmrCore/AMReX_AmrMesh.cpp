@@ -372,6 +372,8 @@ AmrMesh::InitAmrMesh (int max_level_in, const Vector<int>& n_cell_in,
 
     pp.queryAdd("check_input", check_input);
 
+    pp.queryAdd("use_parallel_cluster", use_parallel_cluster);
+
     finest_level = -1;
 
     if (check_input) checkInput();
@@ -675,10 +677,18 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
         // Create initial cluster containing all tagged points.
         //
         Gpu::PinnedVector<IntVect> tagvec;
-        tags.collate(tagvec);
+        Long ntags;
+        if (use_parallel_cluster) {
+            tags.local_collate(tagvec);
+            ntags = tagvec.size();
+            ParallelDescriptor::ReduceLongSum(ntags);
+        } else {
+            tags.collate(tagvec);
+            ntags = tagvec.size();
+        }
         tags.clear();
 
-        if (tagvec.size() > 0)
+        if (ntags > 0)
         {
             //
             // Created new level, now generate efficient grids.
@@ -689,23 +699,35 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
 
             if (levf > useFixedUpToLevel()) {
                 BoxList new_bx;
-                if (ParallelDescriptor::IOProcessor()) {
-                    BL_PROFILE("AmrMesh-cluster");
+                if (use_parallel_cluster) {
+                    BL_PROFILE("AmrMesh-parallel-cluster");
                     //
-                    // Construct initial cluster.
+                    // Each process clusters the tags in its own boxes.
                     //
-                    ClusterList clist(&tagvec[0], tagvec.size());
-                    if (use_new_chop) {
-                        clist.new_chop(grid_eff);
-                    } else {
-                        clist.chop(grid_eff);
+                    if (!tagvec.empty()) {
+                        ClusterList clist(&tagvec[0], tagvec.size());
+                        if (use_new_chop) {
+                            clist.new_chop(grid_eff);
+                        } else {
+                            clist.chop(grid_eff);
+                        }
+                        clist.intersect(p_n_ba[levc]);
+                        clist.boxList(new_bx);
                     }
-                    clist.intersect(p_n_ba[levc]);
                     //
-                    // Efficient properly nested Clusters have been constructed
-                    // now generate list of grids at level levf.
+                    // Merge the clusters of all processes.  The tags are
+                    // owned by exactly one process, but clusters from
+                    // different processes may overlap.  Removing the
+                    // overlap can only increase the grid efficiency.
                     //
-                    clist.boxList(new_bx);
+                    Vector<Box> allboxes(new_bx.begin(), new_bx.end());
+                    AllGatherBoxes(allboxes);
+                    new_bx.clear();
+                    if (!allboxes.empty()) {
+                        BoxArray allba(BoxList(std::move(allboxes)));
+                        allba.removeOverlap();
+                        new_bx = allba.boxList();
+                    }
                     new_bx.refine(bf_lev[levc]);
                     new_bx.simplify();
 
@@ -713,8 +735,34 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
                         // Chop new grids outside domain
                         new_bx.intersect(Geom(levc).Domain());
                     }
+                } else {
+                    if (ParallelDescriptor::IOProcessor()) {
+                        BL_PROFILE("AmrMesh-cluster");
+                        //
+                        // Construct initial cluster.
+                        //
+                        ClusterList clist(&tagvec[0], tagvec.size());
+                        if (use_new_chop) {
+                            clist.new_chop(grid_eff);
+                        } else {
+                            clist.chop(grid_eff);
+                        }
+                        clist.intersect(p_n_ba[levc]);
+                        //
+                        // Efficient properly nested Clusters have been constructed
+                        // now generate list of grids at level levf.
+                        //
+                        clist.boxList(new_bx);
+                        new_bx.refine(bf_lev[levc]);
+                        new_bx.simplify();
+
+                        if (new_bx.size()>0) {
+                            // Chop new grids outside domain
+                            new_bx.intersect(Geom(levc).Domain());
+                        }
+                    }
+                    new_bx.Bcast();  // Broadcast the new BoxList to other processes
                 }
-                new_bx.Bcast();  // Broadcast the new BoxList to other processes
 
                 //
                 // Refine up to levf.
@@ -1038,6 +1086,7 @@ std::ostream& operator<< (std::ostream& os, AmrMesh const& amr_mesh)
     os << "  check_input = " << amr_mesh.check_input  << "\n";
     os << "  use_new_chop = " << amr_mesh.use_new_chop << "\n";
     os << "  iterate_on_new_grids = " << amr_mesh.iterate_on_new_grids << "\n";
+    os << "  use_parallel_cluster = " << amr_mesh.use_parallel_cluster << "\n";
     return os;
 }
 
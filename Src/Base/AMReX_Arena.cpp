@@ -49,6 +49,8 @@ namespace {
     bool the_arena_is_managed = true;
 #endif
     bool abort_on_out_of_gpu_memory = false;
+    int the_arena_thread_cache_size = 0;
+    Long the_arena_thread_cache_max_block_size = 4*1024*1024;
 }
 
 const std::size_t Arena::align_size;
@@ -282,23 +284,32 @@ Arena::Initialize ()
     pp.queryAdd(  "the_async_arena_release_threshold",   the_async_arena_release_threshold);
     pp.queryAdd("the_arena_is_managed", the_arena_is_managed);
     pp.queryAdd("abort_on_out_of_gpu_memory", abort_on_out_of_gpu_memory);
+    pp.queryAdd("the_arena_thread_cache_size", the_arena_thread_cache_size);
+    pp.queryAdd("the_arena_thread_cache_max_block_size", the_arena_thread_cache_max_block_size);
 
     {
 #if defined(BL_COALESCE_FABS) || defined(AMREX_USE_GPU)
-        ArenaInfo ai{};
-        ai.SetReleaseThreshold(the_arena_release_threshold);
-        if (the_arena_is_managed) {
-            the_arena = new CArena(0, ai.SetPreferred());
-        } else {
-            the_arena = new CArena(0, ai.SetDeviceMemory());
-        }
-#ifdef AMREX_USE_GPU
-        void *p = the_arena->alloc(static_cast<std::size_t>(the_arena_init_size));
-        the_arena->free(p);
-#endif
+        const bool use_carena = true;
 #else
-        the_arena = The_BArena();
+        // The thread cache needs a CArena.
+        const bool use_carena = the_arena_thread_cache_size > 0;
 #endif
+        if (use_carena) {
+            ArenaInfo ai{};
+            ai.SetReleaseThreshold(the_arena_release_threshold);
+            ai.SetThreadCache(the_arena_thread_cache_size, the_arena_thread_cache_max_block_size);
+            if (the_arena_is_managed) {
+                the_arena = new CArena(0, ai.SetPreferred());
+            } else {
+                the_arena = new CArena(0, ai.SetDeviceMemory());
+            }
+#ifdef AMREX_USE_GPU
+            void *p = the_arena->alloc(static_cast<std::size_t>(the_arena_init_size));
+            the_arena->free(p);
+#endif
+        } else {
+            the_arena = The_BArena();
+        }
     }
 
     the_async_arena = new PArena(the_async_arena_release_threshold);
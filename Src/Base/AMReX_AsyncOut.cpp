@@ -6,6 +6,10 @@
 #include <AMReX_Utility.H>
 #include <AMReX.H>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
 namespace amrex {
 namespace AsyncOut {
 
@@ -19,6 +23,11 @@ std::unique_ptr<BackgroundThread> s_thread;
 
 WriteInfo s_info;
 
+Long s_max_staging_bytes = 0;
+Long s_staging_bytes = 0;
+std::mutex s_staging_mutex;
+std::condition_variable s_staging_cond;
+
 }
 
 void Initialize ()
@@ -28,6 +37,7 @@ void Initialize ()
     ParmParse pp("amrex");
     pp.queryAdd("async_out", s_asyncout);
     pp.queryAdd("async_out_nfiles", s_noutfiles);
+    pp.queryAdd("async_out_max_staging_bytes", s_max_staging_bytes);
 
     int nprocs = ParallelDescriptor::NProcs();
     s_noutfiles = std::min(s_noutfiles, nprocs);
@@ -110,6 +120,57 @@ void Finish ()
     }
 }
 
+void WriteHandle::wait () const
+{
+    if (m_future.valid()) {
+        m_future.wait();
+    }
+}
+
+bool WriteHandle::isReady () const
+{
+    return !m_future.valid()
+        || m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+WriteHandle GetWriteHandle ()
+{
+    if (s_thread) {
+        auto p = std::make_shared<std::promise<void> >();
+        WriteHandle h(p->get_future().share());
+        s_thread->Submit([p] () { p->set_value(); });
+        return h;
+    } else {
+        return WriteHandle();
+    }
+}
+
+void ReserveStaging (Long nbytes)
+{
+    std::unique_lock<std::mutex> lck(s_staging_mutex);
+    if (s_max_staging_bytes > 0) {
+        s_staging_cond.wait(lck, [=] () -> bool {
+            return s_staging_bytes == 0 || s_staging_bytes + nbytes <= s_max_staging_bytes;
+        });
+    }
+    s_staging_bytes += nbytes;
+}
+
+void ReleaseStaging (Long nbytes)
+{
+    {
+        std::lock_guard<std::mutex> lck(s_staging_mutex);
+        s_staging_bytes -= nbytes;
+    }
+    s_staging_cond.notify_all();
+}
+
+Long StagingBytes ()
+{
+    std::lock_guard<std::mutex> lck(s_staging_mutex);
+    return s_staging_bytes;
+}
+
 void Wait ()
 {
 #ifdef AMREX_USE_MPI
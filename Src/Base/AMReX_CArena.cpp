@@ -2,13 +2,47 @@
 #include <AMReX_CArena.H>
 #include <AMReX_BLassert.H>
 #include <AMReX_Gpu.H>
+#include <AMReX_OpenMP.H>
 #include <AMReX_ParallelReduce.H>
 
+#include <algorithm>
 #include <utility>
 #include <cstring>
 
 namespace amrex {
 
+namespace {
+
+// Four size classes per power of two above 256 bytes, so that rounding up
+// wastes at most 25%.  On return, nbytes is the size of the class.
+int thread_cache_size_class (std::size_t& nbytes) noexcept
+{
+    if (nbytes <= 256) {
+        nbytes = 256;
+        return 0;
+    }
+    std::size_t s = nbytes-1;
+    int e = 8;
+    while ((s >> (e+1)) != 0) { ++e; }
+    std::size_t step = std::size_t(1) << (e-2);
+    std::size_t q = s / step; // 4, 5, 6 or 7
+    nbytes = (q+1)*step;
+    return 1 + (e-8)*4 + static_cast<int>(q-4);
+}
+
+std::size_t thread_cache_class_bytes (int sc) noexcept
+{
+    if (sc == 0) {
+        return 256;
+    } else {
+        int e = 8 + (sc-1)/4;
+        std::size_t q = 4 + (sc-1)%4;
+        return (q+1) << (e-2);
+    }
+}
+
+}
+
 CArena::CArena (std::size_t hunk_size, ArenaInfo info)
 {
     arena_info = info;
@@ -21,6 +55,16 @@ CArena::CArena (std::size_t hunk_size, ArenaInfo info)
 
     BL_ASSERT(m_hunk >= hunk_size);
     BL_ASSERT(m_hunk%Arena::align_size == 0);
+
+    if (info.thread_cache_size > 0 && isHostAccessible()) {
+        m_thread_cache_size = info.thread_cache_size;
+        m_cache_header = Arena::align_size;
+        m_thread_cache_max_block = static_cast<std::size_t>(info.thread_cache_max_block_size);
+        int nthreads = std::max(OpenMP::get_max_threads(), 1);
+        for (int i = 0; i < nthreads; ++i) {
+            m_thread_caches.push_back(std::make_unique<ThreadCache>());
+        }
+    }
 }
 
 CArena::~CArena ()
@@ -30,11 +74,52 @@ CArena::~CArena ()
     }
 }
 
+CArena::ThreadCache&
+CArena::thread_cache () noexcept
+{
+    // Threads that share an OpenMP thread number (e.g., nested parallel
+    // regions) share a cache, which is protected by its own mutex.
+    auto i = static_cast<std::size_t>(OpenMP::get_thread_num()) % m_thread_caches.size();
+    return *m_thread_caches[i];
+}
+
 void*
 CArena::alloc (std::size_t nbytes)
 {
-    std::lock_guard<std::mutex> lock(carena_mutex);
+    if (m_thread_cache_size == 0)
+    {
+        std::lock_guard<std::mutex> lock(carena_mutex);
+        return alloc_protected(nbytes);
+    }
+
+    int sc = -1;
+    if (nbytes <= m_thread_cache_max_block)
+    {
+        sc = thread_cache_size_class(nbytes);
+        auto& tc = thread_cache();
+        std::lock_guard<std::mutex> lock(tc.mutex);
+        if (sc < static_cast<int>(tc.bins.size()) && !tc.bins[sc].empty()) {
+            void* vp = tc.bins[sc].back();
+            tc.bins[sc].pop_back();
+            ++tc.hits;
+            return vp;
+        } else {
+            ++tc.misses;
+        }
+    }
+
+    char* p;
+    {
+        std::lock_guard<std::mutex> lock(carena_mutex);
+        p = static_cast<char*>(alloc_protected(nbytes+m_cache_header));
+    }
+    std::memcpy(p, &sc, sizeof(int));
+    return p + m_cache_header;
+}
 
+void*
+CArena::alloc_protected (std::size_t nbytes)
+{
     nbytes = Arena::align(nbytes == 0 ? 1 : nbytes);
 
     if (static_cast<Long>(m_used+nbytes) >= arena_info.release_threshold) {
@@ -122,8 +207,32 @@ CArena::free (void* vp)
         return;
     }
 
+    if (m_thread_cache_size > 0)
+    {
+        char* p = static_cast<char*>(vp) - m_cache_header;
+        int sc;
+        std::memcpy(&sc, p, sizeof(int));
+        if (sc >= 0) {
+            auto& tc = thread_cache();
+            std::lock_guard<std::mutex> lock(tc.mutex);
+            if (sc >= static_cast<int>(tc.bins.size())) {
+                tc.bins.resize(sc+1);
+            }
+            if (static_cast<int>(tc.bins[sc].size()) < m_thread_cache_size) {
+                tc.bins[sc].push_back(vp);
+                return;
+            }
+        }
+        vp = p;
+    }
+
     std::lock_guard<std::mutex> lock(carena_mutex);
+    free_protected(vp);
+}
 
+void
+CArena::free_protected (void* vp)
+{
     //
     // `vp' had better be in the busy list.
     //
@@ -201,10 +310,42 @@ CArena::free (void* vp)
 std::size_t
 CArena::freeUnused ()
 {
+    flushThreadCache();
     std::lock_guard<std::mutex> lock(carena_mutex);
     return freeUnused_protected();
 }
 
+void
+CArena::flushThreadCache ()
+{
+    for (auto& tc : m_thread_caches) {
+        std::vector<void*> blocks;
+        {
+            std::lock_guard<std::mutex> lock(tc->mutex);
+            for (auto& bin : tc->bins) {
+                blocks.insert(blocks.end(), bin.begin(), bin.end());
+                bin.clear();
+            }
+        }
+        std::lock_guard<std::mutex> lock(carena_mutex);
+        for (auto* p : blocks) {
+            free_protected(static_cast<char*>(p) - m_cache_header);
+        }
+    }
+}
+
+std::pair<Long,Long>
+CArena::threadCacheHitsMisses () const
+{
+    Long hits = 0, misses = 0;
+    for (auto const& tc : m_thread_caches) {
+        std::lock_guard<std::mutex> lock(tc->mutex);
+        hits += tc->hits;
+        misses += tc->misses;
+    }
+    return std::make_pair(hits, misses);
+}
+
 std::size_t
 CArena::freeUnused_protected ()
 {
@@ -287,11 +428,11 @@ CArena::sizeOf (void* p) const noexcept
     if (p == nullptr) {
         return 0;
     } else {
-        auto it = m_busylist.find(Node(p,0,0));
+        auto it = m_busylist.find(Node(static_cast<char*>(p)-m_cache_header,0,0));
         if (it == m_busylist.end()) {
             return 0;
         } else {
-            return it->size();
+            return it->size() - m_cache_header;
         }
     }
 }
@@ -317,6 +458,15 @@ CArena::PrintUsage (std::string const& name) const
     amrex::Print() << "[" << name << "] space allocated (MB): " << min_megabytes << "\n";
     amrex::Print() << "[" << name << "] space used      (MB): " << actual_min_megabytes << "\n";
 #endif
+    if (m_thread_cache_size > 0) {
+        auto hm = threadCacheHitsMisses();
+        ParallelReduce::Sum<Long>({hm.first, hm.second},
+                                  IOProc, ParallelDescriptor::Communicator());
+        Long ntot = std::max(hm.first+hm.second, Long(1));
+        amrex::Print() << "[" << name << "] thread cache hits: " << hm.first
+                       << ", misses: " << hm.second << ", hit rate: "
+                       << (100*hm.first)/ntot << "%\n";
+    }
 }
 
 void
@@ -328,6 +478,20 @@ CArena::PrintUsage (std::ostream& os, std::string const& name, std::string const
     os << space << "[" << name << "] space used      (MB): " << actual_megabytes << "\n";
     os << space << "[" << name << "]: " << m_alloc.size() << " allocs, "
        << m_busylist.size() << " busy blocks, " << m_freelist.size() << " free blocks\n";
+    if (m_thread_cache_size > 0) {
+        auto hm = threadCacheHitsMisses();
+        std::size_t cached_bytes = 0;
+        for (auto const& tc : m_thread_caches) {
+            std::lock_guard<std::mutex> lock(tc->mutex);
+            for (int sc = 0, nsc = static_cast<int>(tc->bins.size()); sc < nsc; ++sc) {
+                cached_bytes += tc->bins[sc].size() * thread_cache_class_bytes(sc);
+            }
+        }
+        Long ntot = std::max(hm.first+hm.second, Long(1));
+        os << space << "[" << name << "] thread cache: " << hm.first << " hits, "
+           << hm.second << " misses, hit rate " << (100*hm.first)/ntot << "%, "
+           << cached_bytes/(1024*1024) << " MB cached\n";
+    }
 }
 
 }
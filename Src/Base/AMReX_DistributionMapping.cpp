@@ -9,6 +9,7 @@
 #include <AMReX_VisMF.H>
 #include <AMReX_Utility.H>
 #include <AMReX_Morton.H>
+#include <AMReX_Machine.H>
 
 #include <iostream>
 #include <fstream>
@@ -37,6 +38,7 @@ namespace amrex {
     int    sfc_threshold;
     Real   max_efficiency;
     int    node_size;
+    Real   graph_load_tolerance;
 
 // We default to SFC.
 DistributionMapping::Strategy DistributionMapping::m_Strategy = DistributionMapping::SFC;
@@ -74,6 +76,15 @@ DistributionMapping::strategy (DistributionMapping::Strategy how)
     case RRSFC:
         m_BuildMap = &DistributionMapping::RRSFCProcessorMap;
         break;
+    case HILBERT:
+        m_BuildMap = &DistributionMapping::HilbertProcessorMap;
+        break;
+    case GRAPH:
+        m_BuildMap = &DistributionMapping::GraphProcessorMap;
+        break;
+    case NODEAWARE:
+        m_BuildMap = &DistributionMapping::NodeAwareProcessorMap;
+        break;
     default:
         amrex::Error("Bad DistributionMapping::Strategy");
     }
@@ -114,6 +125,7 @@ DistributionMapping::Initialize ()
     sfc_threshold    = 0;
     max_efficiency   = 0.9_rt;
     node_size        = 0;
+    graph_load_tolerance = 0.0_rt;
     flag_verbose_mapper = 0;
 
     ParmParse pp("DistributionMapping");
@@ -123,6 +135,7 @@ DistributionMapping::Initialize ()
     pp.queryAdd("efficiency",          max_efficiency);
     pp.queryAdd("sfc_threshold",       sfc_threshold);
     pp.queryAdd("node_size",           node_size);
+    pp.queryAdd("graph_load_tolerance", graph_load_tolerance);
     pp.queryAdd("verbose_mapper",      flag_verbose_mapper);
 
     std::string theStrategy;
@@ -145,6 +158,18 @@ DistributionMapping::Initialize ()
         {
             strategy(RRSFC);
         }
+        else if (theStrategy == "HILBERT")
+        {
+            strategy(HILBERT);
+        }
+        else if (theStrategy == "GRAPH")
+        {
+            strategy(GRAPH);
+        }
+        else if (theStrategy == "NODEAWARE")
+        {
+            strategy(NODEAWARE);
+        }
         else
         {
             std::string msg("Unknown strategy: ");
@@ -906,7 +931,8 @@ namespace
                               const SFCToken& rhs) const;
         };
         int m_box;
-        Array<uint32_t,AMREX_SPACEDIM> m_morton;
+        //! Index along the curve, most significant word last.
+        Array<uint32_t,AMREX_SPACEDIM> m_key;
     };
 }
 
@@ -916,17 +942,17 @@ SFCToken::Compare::operator () (const SFCToken& lhs,
                                 const SFCToken& rhs) const
 {
 #if (AMREX_SPACEDIM == 1)
-        return lhs.m_morton[0] < rhs.m_morton[0];
+        return lhs.m_key[0] < rhs.m_key[0];
 #elif (AMREX_SPACEDIM == 2)
-        return (lhs.m_morton[1] <  rhs.m_morton[1]) ||
-              ((lhs.m_morton[1] == rhs.m_morton[1]) &&
-               (lhs.m_morton[0] <  rhs.m_morton[0]));
+        return (lhs.m_key[1] <  rhs.m_key[1]) ||
+              ((lhs.m_key[1] == rhs.m_key[1]) &&
+               (lhs.m_key[0] <  rhs.m_key[0]));
 #else
-        return (lhs.m_morton[2] <  rhs.m_morton[2]) ||
-              ((lhs.m_morton[2] == rhs.m_morton[2]) &&
-              ((lhs.m_morton[1] <  rhs.m_morton[1]) ||
-              ((lhs.m_morton[1] == rhs.m_morton[1]) &&
-               (lhs.m_morton[0] <  rhs.m_morton[0]))));
+        return (lhs.m_key[2] <  rhs.m_key[2]) ||
+              ((lhs.m_key[2] == rhs.m_key[2]) &&
+              ((lhs.m_key[1] <  rhs.m_key[1]) ||
+              ((lhs.m_key[1] == rhs.m_key[1]) &&
+               (lhs.m_key[0] <  rhs.m_key[0]))));
 #endif
 }
 
@@ -949,19 +975,19 @@ namespace {
         uint32_t y = iv[1] - imin;
         uint32_t z = iv[2] - imin;
         // extract lowest 10 bits and make space for interleaving
-        token.m_morton[0] = Morton::makeSpace(x & 0x3FF)
+        token.m_key[0] = Morton::makeSpace(x & 0x3FF)
                          | (Morton::makeSpace(y & 0x3FF) << 1)
                          | (Morton::makeSpace(z & 0x3FF) << 2);
         x = x >> 10;
         y = y >> 10;
         z = z >> 10;
-        token.m_morton[1] = Morton::makeSpace(x & 0x3FF)
+        token.m_key[1] = Morton::makeSpace(x & 0x3FF)
                          | (Morton::makeSpace(y & 0x3FF) << 1)
                          | (Morton::makeSpace(z & 0x3FF) << 2);
         x = x >> 10;
         y = y >> 10;
         z = z >> 10;
-        token.m_morton[2] = Morton::makeSpace(x & 0x3FF)
+        token.m_key[2] = Morton::makeSpace(x & 0x3FF)
                          | (Morton::makeSpace(y & 0x3FF) << 1)
                          | (Morton::makeSpace(z & 0x3FF) << 2);
 
@@ -975,18 +1001,18 @@ namespace {
         uint32_t y = (iv[1] >= 0) ? static_cast<uint32_t>(iv[1]) + offset
             : static_cast<uint32_t>(iv[1]-std::numeric_limits<int>::lowest());
         // extract lowest 16 bits and make sapce for interleaving
-        token.m_morton[0] = Morton::makeSpace(x & 0xFFFF)
+        token.m_key[0] = Morton::makeSpace(x & 0xFFFF)
                          | (Morton::makeSpace(y & 0xFFFF) << 1);
         x = x >> 16;
         y = y >> 16;
-        token.m_morton[1] = Morton::makeSpace(x) | (Morton::makeSpace(y) << 1);
+        token.m_key[1] = Morton::makeSpace(x) | (Morton::makeSpace(y) << 1);
 
 #elif (AMREX_SPACEDIM == 1)
 
         constexpr uint32_t offset = 1u << 31;
         static_assert(static_cast<uint32_t>(std::numeric_limits<int>::max())+1 == offset,
                       "INT_MAX != (1<<31)-1");
-        token.m_morton[0] = (iv[0] >= 0) ? static_cast<uint32_t>(iv[0]) + offset
+        token.m_key[0] = (iv[0] >= 0) ? static_cast<uint32_t>(iv[0]) + offset
             : static_cast<uint32_t>(iv[0]-std::numeric_limits<int>::lowest());
 
 #else
@@ -995,6 +1021,228 @@ namespace {
 
         return token;
     }
+
+    // Transforms the coordinates in place to the "transposed" Hilbert index
+    // (J. Skilling, Programming the Hilbert curve, AIP Conf. Proc. 707, 2004).
+    void hilbertAxesToTranspose (uint32_t* X, int nbits)
+    {
+        constexpr int n = AMREX_SPACEDIM;
+        const uint32_t M = 1u << (nbits-1);
+        // Inverse undo
+        for (uint32_t Q = M; Q > 1; Q >>= 1) {
+            const uint32_t P = Q - 1;
+            for (int i = 0; i < n; ++i) {
+                if (X[i] & Q) {
+                    X[0] ^= P;
+                } else {
+                    uint32_t t = (X[0] ^ X[i]) & P;
+                    X[0] ^= t;
+                    X[i] ^= t;
+                }
+            }
+        }
+        // Gray encode
+        for (int i = 1; i < n; ++i) {
+            X[i] ^= X[i-1];
+        }
+        uint32_t t = 0;
+        for (uint32_t Q = M; Q > 1; Q >>= 1) {
+            if (X[n-1] & Q) { t ^= Q-1; }
+        }
+        for (int i = 0; i < n; ++i) {
+            X[i] ^= t;
+        }
+    }
+
+    // Tokens with the Hilbert index of the box centers.  The curve covers
+    // the minimal box of the BoxArray, coarsened if needed so that the
+    // index fits in 64 bits.
+    std::vector<SFCToken> makeHilbertTokens (const BoxArray& boxes)
+    {
+        const int N = boxes.size();
+        std::vector<SFCToken> tokens;
+        tokens.reserve(N);
+        if (N == 0) { return tokens; }
+
+        const Box mbx = boxes.minimalBox();
+        const IntVect lo = mbx.smallEnd();
+        const auto len = static_cast<uint32_t>(mbx.longside());
+        constexpr int maxbits = (AMREX_SPACEDIM == 3) ? 21 : 32;
+        int nbits = 1;
+        while (nbits < 32 && ((len-1) >> nbits) != 0) { ++nbits; }
+        const int shift = std::max(nbits-maxbits, 0);
+        nbits -= shift;
+
+        for (int i = 0; i < N; ++i)
+        {
+            const Box& bx = boxes[i];
+            uint32_t X[AMREX_SPACEDIM];
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                int c = bx.smallEnd(idim) + (bx.bigEnd(idim)-bx.smallEnd(idim))/2;
+                X[idim] = static_cast<uint32_t>(c - lo[idim]) >> shift;
+            }
+            hilbertAxesToTranspose(X, nbits);
+            uint64_t h = 0;
+            for (int q = nbits-1; q >= 0; --q) {
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    h = (h << 1) | ((X[idim] >> q) & 1u);
+                }
+            }
+            SFCToken token;
+            token.m_box = i;
+            token.m_key[0] = static_cast<uint32_t>(h);
+#if (AMREX_SPACEDIM > 1)
+            token.m_key[1] = static_cast<uint32_t>(h >> 32);
+#endif
+#if (AMREX_SPACEDIM == 3)
+            token.m_key[2] = 0;
+#endif
+            tokens.push_back(token);
+        }
+
+        return tokens;
+    }
+
+    // Moves boxes to the part with which they share the most face area, as
+    // long as that reduces the area of the faces between different parts
+    // and the load of the receiving part stays below its maxload.
+    void refinePartition (const BoxArray& boxes, const std::vector<Long>& wgts,
+                          const std::vector<Long>& maxload,
+                          std::vector<std::vector<int> >& vec)
+    {
+        BL_PROFILE("DistributionMapping::refinePartition()");
+
+        const int N = boxes.size();
+        const int nparts = vec.size();
+
+        std::vector<int> part(N);
+        std::vector<Long> load(nparts, 0);
+        std::vector<int> count(nparts, 0);
+        for (int p = 0; p < nparts; ++p) {
+            for (int i : vec[p]) {
+                part[i] = p;
+                load[p] += wgts[i];
+                ++count[p];
+            }
+        }
+
+        // Face neighbors and the area of the shared faces.  Growing a box
+        // in one direction only finds the neighbors across its faces in
+        // that direction, and the intersection is the shared face.
+        std::vector<std::vector<std::pair<int,Long> > > adj(N);
+        std::vector<std::pair<int,Box> > isects;
+        for (int i = 0; i < N; ++i) {
+            const Box& bx = boxes[i];
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                boxes.intersections(amrex::grow(bx,idim,1), isects);
+                for (auto const& is : isects) {
+                    if (is.first != i) {
+                        adj[i].emplace_back(is.first, is.second.numPts());
+                    }
+                }
+            }
+        }
+
+        constexpr int max_passes = 8;
+        std::vector<std::pair<int,Long> > conn;
+        for (int pass = 0; pass < max_passes; ++pass)
+        {
+            int nmoved = 0;
+            for (int i = 0; i < N; ++i)
+            {
+                const int p = part[i];
+                if (count[p] == 1) { continue; }
+
+                conn.clear();
+                for (auto const& nb : adj[i]) {
+                    const int q = part[nb.first];
+                    auto it = std::find_if(conn.begin(), conn.end(),
+                                           [q] (std::pair<int,Long> const& c)
+                                           { return c.first == q; });
+                    if (it == conn.end()) {
+                        conn.emplace_back(q, nb.second);
+                    } else {
+                        it->second += nb.second;
+                    }
+                }
+
+                Long internal = 0;
+                for (auto const& c : conn) {
+                    if (c.first == p) { internal = c.second; }
+                }
+
+                int best = -1;
+                Long best_gain = 0;
+                for (auto const& c : conn) {
+                    const int q = c.first;
+                    const Long gain = c.second - internal;
+                    if (q != p && gain > best_gain && load[q]+wgts[i] <= maxload[q]) {
+                        best = q;
+                        best_gain = gain;
+                    }
+                }
+
+                if (best >= 0) {
+                    part[i] = best;
+                    load[p] -= wgts[i];
+                    load[best] += wgts[i];
+                    --count[p];
+                    ++count[best];
+                    ++nmoved;
+                }
+            }
+
+            if (flag_verbose_mapper) {
+                Print() << "refinePartition: pass " << pass << " moved " << nmoved
+                        << " boxes" << std::endl;
+            }
+            if (nmoved == 0) { break; }
+        }
+
+        std::vector<std::vector<int> > newvec(nparts);
+        for (auto const& v : vec) {
+            for (int i : v) {
+                newvec[part[i]].push_back(i);
+            }
+        }
+        std::swap(vec, newvec);
+    }
+
+    // Splits the boxes, in the given order, into consecutive chunks whose
+    // costs are proportional to shares.
+    std::vector<std::vector<int> > splitCurve (const std::vector<int>& order,
+                                               const std::vector<Long>& wgts,
+                                               const std::vector<Real>& shares)
+    {
+        const int nparts = shares.size();
+        std::vector<std::vector<int> > vec(nparts);
+        Real total = 0;
+        for (int i : order) { total += wgts[i]; }
+        Real cum = 0;
+        Real bound = shares[0]*total;
+        int k = 0;
+        for (int i : order) {
+            while (k < nparts-1 && cum + 0.5_rt*wgts[i] > bound) {
+                ++k;
+                bound += shares[k]*total;
+            }
+            vec[k].push_back(i);
+            cum += wgts[i];
+        }
+        return vec;
+    }
+
+    // The node of a global rank.  DistributionMapping.node_size can be used
+    // to emulate nodes of consecutive ranks.
+    int node_of_rank (int rank)
+    {
+        if (node_size > 0) {
+            return rank / node_size;
+        } else {
+            const Vector<int>& ids = machine::shared_memory_node_ids();
+            return (rank < ids.size()) ? ids[rank] : rank;
+        }
+    }
 }
 
 static
@@ -1016,7 +1264,7 @@ Distribute (const std::vector<SFCToken>&     tokens,
         for (const auto &t : tokens) {
             Print() << "    " << idx++ << ": "
                     << t.m_box << ": "
-                    << t.m_morton << std::endl;
+                    << t.m_key << std::endl;
         }
     }
 
@@ -1064,7 +1312,7 @@ Distribute (const std::vector<SFCToken>&     tokens,
                 BL_ASSERT(box == t.m_box);
                 Print() << "    " << idx << ": "
                         << t.m_box << ": "
-                        << t.m_morton << std::endl;
+                        << t.m_key << std::endl;
                 rank_vol += wgts[t.m_box];
                 idx++;
             }
@@ -1397,6 +1645,418 @@ DistributionMapping::RRSFCProcessorMap (const BoxArray&          boxes,
     RRSFCDoIt(boxes,nprocs);
 }
 
+void
+DistributionMapping::HilbertProcessorMapDoIt (const BoxArray&          boxes,
+                                              const std::vector<Long>& wgts,
+                                              int                      nprocs,
+                                              bool                     graph,
+                                              bool                     sort,
+                                              Real*                    eff)
+{
+    BL_PROFILE("DistributionMapping::HilbertProcessorMapDoIt()");
+
+    std::vector<SFCToken> tokens = makeHilbertTokens(boxes);
+    //
+    // Put'm in Hilbert space filling curve order.
+    //
+    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    //
+    // Split'm up as equitably as possible per CPU.
+    //
+    Real volpercpu = 0;
+    for (Long wt : wgts) {
+        volpercpu += wt;
+    }
+    volpercpu /= nprocs;
+
+    std::vector< std::vector<int> > vec(nprocs);
+
+    Distribute(tokens,wgts,nprocs,volpercpu,vec);
+
+    tokens.clear();
+
+    if (graph)
+    {
+        Long maxload = 0;
+        for (auto const& v : vec) {
+            Long load = 0;
+            for (int i : v) { load += wgts[i]; }
+            maxload = std::max(maxload, load);
+        }
+        maxload = std::max(maxload, static_cast<Long>(volpercpu*(1.0_rt+graph_load_tolerance)));
+        refinePartition(boxes, wgts, std::vector<Long>(nprocs,maxload), vec);
+    }
+
+    std::vector<LIpair> LIpairV;
+
+    LIpairV.reserve(nprocs);
+
+    for (int i = 0; i < nprocs; ++i)
+    {
+        Long wgt = 0;
+        for (int j : vec[i]) {
+            wgt += wgts[j];
+        }
+        LIpairV.push_back(LIpair(wgt,i));
+    }
+
+    if (sort) Sort(LIpairV, true);
+
+    Vector<int> ord;
+    if (sort) {
+        LeastUsedCPUs(nprocs,ord);
+    } else {
+        ord.resize(nprocs);
+        std::iota(ord.begin(), ord.end(), 0);
+    }
+
+    for (int i = 0; i < nprocs; ++i)
+    {
+        const int rank = ParallelContext::local_to_global_rank(ord[i]);
+        for (int j : vec[LIpairV[i].second]) {
+            m_ref->m_pmap[j] = rank;
+        }
+    }
+
+    if (eff || verbose)
+    {
+        Real sum_wgt = 0, max_wgt = 0;
+        for (auto const& p : LIpairV)
+        {
+            if (p.first > max_wgt) max_wgt = p.first;
+            sum_wgt += p.first;
+        }
+        Real efficiency = (sum_wgt/(nprocs*max_wgt));
+        if (eff) *eff = efficiency;
+
+        if (verbose)
+        {
+            amrex::Print() << (graph ? "GRAPH" : "HILBERT") << " efficiency: " << efficiency
+                           << ", halo bytes: "
+                           << ComputeDistributionMappingHaloBytes(*this, boxes) << '\n';
+        }
+    }
+}
+
+void
+DistributionMapping::HilbertProcessorMap (const BoxArray& boxes,
+                                          int             nprocs)
+{
+    std::vector<Long> wgts;
+    wgts.reserve(boxes.size());
+    for (int i = 0, N = boxes.size(); i < N; ++i) {
+        wgts.push_back(boxes[i].volume());
+    }
+    HilbertProcessorMap(boxes,wgts,nprocs);
+}
+
+void
+DistributionMapping::HilbertProcessorMap (const BoxArray&          boxes,
+                                          const std::vector<Long>& wgts,
+                                          int                      nprocs,
+                                          bool                     sort)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs);
+    }
+    else
+    {
+        HilbertProcessorMapDoIt(boxes,wgts,nprocs,false,sort);
+    }
+}
+
+void
+DistributionMapping::HilbertProcessorMap (const BoxArray&          boxes,
+                                          const std::vector<Long>& wgts,
+                                          int                      nprocs,
+                                          Real&                    eff,
+                                          bool                     sort)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs,&eff);
+    }
+    else
+    {
+        HilbertProcessorMapDoIt(boxes,wgts,nprocs,false,sort,&eff);
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray& boxes,
+                                        int             nprocs)
+{
+    std::vector<Long> wgts;
+    wgts.reserve(boxes.size());
+    for (int i = 0, N = boxes.size(); i < N; ++i) {
+        wgts.push_back(boxes[i].volume());
+    }
+    GraphProcessorMap(boxes,wgts,nprocs);
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray&          boxes,
+                                        const std::vector<Long>& wgts,
+                                        int                      nprocs,
+                                        bool                     sort)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs);
+    }
+    else
+    {
+        HilbertProcessorMapDoIt(boxes,wgts,nprocs,true,sort);
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray&          boxes,
+                                        const std::vector<Long>& wgts,
+                                        int                      nprocs,
+                                        Real&                    eff,
+                                        bool                     sort)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs,&eff);
+    }
+    else
+    {
+        HilbertProcessorMapDoIt(boxes,wgts,nprocs,true,sort,&eff);
+    }
+}
+
+void
+DistributionMapping::NodeAwareProcessorMapDoIt (const BoxArray&          boxes,
+                                                const std::vector<Long>& wgts,
+                                                int                      nprocs,
+                                                Real*                    eff)
+{
+    BL_PROFILE("DistributionMapping::NodeAwareProcessorMapDoIt()");
+
+    // The ranks of each node, in order
+    std::vector<std::vector<int> > node_ranks;
+    {
+        std::map<int,int> node_index;
+        for (int r = 0; r < nprocs; ++r) {
+            const int node = node_of_rank(ParallelContext::local_to_global_rank(r));
+            auto it = node_index.find(node);
+            if (it == node_index.end()) {
+                it = node_index.emplace(node, static_cast<int>(node_ranks.size())).first;
+                node_ranks.emplace_back();
+            }
+            node_ranks[it->second].push_back(r);
+        }
+    }
+    const int nnodes = node_ranks.size();
+
+    if (flag_verbose_mapper) {
+        Print() << "DM: NodeAwareProcessorMapDoIt: " << nprocs << " ranks on "
+                << nnodes << " nodes" << std::endl;
+    }
+
+    std::vector<SFCToken> tokens = makeHilbertTokens(boxes);
+    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+    std::vector<int> order;
+    order.reserve(tokens.size());
+    for (auto const& t : tokens) {
+        order.push_back(t.m_box);
+    }
+    tokens.clear();
+
+    std::vector<int> curve_pos(order.size());
+    for (int i = 0, N = order.size(); i < N; ++i) {
+        curve_pos[order[i]] = i;
+    }
+
+    // Each part may grow up to the largest load per rank of the initial
+    // split, or the average load per rank times 1+graph_load_tolerance.
+    auto max_loads = [&] (std::vector<std::vector<int> > const& vec,
+                          std::vector<int> const& nranks, Long avg_per_rank)
+    {
+        Real max_per_rank = avg_per_rank*(1.0_rt+graph_load_tolerance);
+        for (int k = 0, n = vec.size(); k < n; ++k) {
+            Long load = 0;
+            for (int i : vec[k]) { load += wgts[i]; }
+            max_per_rank = std::max(max_per_rank, Real(load)/Real(nranks[k]));
+        }
+        std::vector<Long> maxload(vec.size());
+        for (int k = 0, n = vec.size(); k < n; ++k) {
+            maxload[k] = static_cast<Long>(max_per_rank*nranks[k]);
+        }
+        return maxload;
+    };
+
+    Long total = 0;
+    for (Long wt : wgts) {
+        total += wt;
+    }
+
+    //
+    // Level 1: among the nodes, in proportion to their number of ranks
+    //
+    std::vector<std::vector<int> > node_boxes;
+    {
+        std::vector<Real> shares(nnodes);
+        std::vector<int> nranks(nnodes);
+        for (int k = 0; k < nnodes; ++k) {
+            nranks[k] = node_ranks[k].size();
+            shares[k] = Real(nranks[k]) / Real(nprocs);
+        }
+        node_boxes = splitCurve(order, wgts, shares);
+        if (nnodes > 1) {
+            refinePartition(boxes, wgts, max_loads(node_boxes, nranks, total/nprocs), node_boxes);
+        }
+    }
+
+    //
+    // Level 2: among the ranks of each node
+    //
+    for (int k = 0; k < nnodes; ++k)
+    {
+        std::vector<int>& nb = node_boxes[k];
+        if (nb.empty()) { continue; }
+
+        std::sort(nb.begin(), nb.end(),
+                  [&] (int a, int b) { return curve_pos[a] < curve_pos[b]; });
+
+        const int nr = node_ranks[k].size();
+        BoxList bl;
+        std::vector<Long> lwgts;
+        lwgts.reserve(nb.size());
+        Long node_total = 0;
+        for (int i : nb) {
+            bl.push_back(boxes[i]);
+            lwgts.push_back(wgts[i]);
+            node_total += wgts[i];
+        }
+        BoxArray nba(std::move(bl));
+
+        std::vector<int> lorder(nb.size());
+        std::iota(lorder.begin(), lorder.end(), 0);
+        std::vector<std::vector<int> > rank_boxes
+            = splitCurve(lorder, lwgts, std::vector<Real>(nr, 1.0_rt/nr));
+        if (nr > 1) {
+            std::vector<Long> maxload(nr);
+            Long maxrank = static_cast<Long>(node_total/nr*(1.0_rt+graph_load_tolerance));
+            for (auto const& v : rank_boxes) {
+                Long load = 0;
+                for (int li : v) { load += lwgts[li]; }
+                maxrank = std::max(maxrank, load);
+            }
+            refinePartition(nba, lwgts, std::vector<Long>(nr,maxrank), rank_boxes);
+        }
+
+        for (int j = 0; j < nr; ++j) {
+            const int rank = ParallelContext::local_to_global_rank(node_ranks[k][j]);
+            for (int li : rank_boxes[j]) {
+                m_ref->m_pmap[nb[li]] = rank;
+            }
+        }
+    }
+
+    if (eff || verbose)
+    {
+        std::vector<Long> load(nprocs, 0);
+        for (int i = 0, N = boxes.size(); i < N; ++i) {
+            load[ParallelContext::global_to_local_rank(m_ref->m_pmap[i])] += wgts[i];
+        }
+        Real max_wgt = *std::max_element(load.begin(), load.end());
+        Real efficiency = Real(total)/(nprocs*max_wgt);
+        if (eff) *eff = efficiency;
+
+        if (verbose)
+        {
+            Long intra, inter;
+            ComputeDistributionMappingNodeHaloBytes(*this, boxes, intra, inter);
+            amrex::Print() << "NODEAWARE efficiency: " << efficiency
+                           << ", intra-node halo bytes: " << intra
+                           << ", inter-node halo bytes: " << inter << '\n';
+        }
+    }
+}
+
+void
+DistributionMapping::NodeAwareProcessorMap (const BoxArray& boxes,
+                                            int             nprocs)
+{
+    std::vector<Long> wgts;
+    wgts.reserve(boxes.size());
+    for (int i = 0, N = boxes.size(); i < N; ++i) {
+        wgts.push_back(boxes[i].volume());
+    }
+    NodeAwareProcessorMap(boxes,wgts,nprocs);
+}
+
+void
+DistributionMapping::NodeAwareProcessorMap (const BoxArray&          boxes,
+                                            const std::vector<Long>& wgts,
+                                            int                      nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs);
+    }
+    else
+    {
+        NodeAwareProcessorMapDoIt(boxes,wgts,nprocs);
+    }
+}
+
+void
+DistributionMapping::NodeAwareProcessorMap (const BoxArray&          boxes,
+                                            const std::vector<Long>& wgts,
+                                            int                      nprocs,
+                                            Real&                    eff)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs,&eff);
+    }
+    else
+    {
+        NodeAwareProcessorMapDoIt(boxes,wgts,nprocs,&eff);
+    }
+}
+
 DistributionMapping
 DistributionMapping::makeKnapSack (const Vector<Real>& rcost, int nmax)
 {
@@ -1557,6 +2217,62 @@ DistributionMapping::ComputeDistributionMappingEfficiency (const DistributionMap
                                    rankToCost.end(), 0.0_rt) / (nprocs*maxCost));
 }
 
+Long
+DistributionMapping::ComputeDistributionMappingHaloBytes (const DistributionMapping& dm,
+                                                          const BoxArray& ba,
+                                                          const IntVect& nghost,
+                                                          int ncomp)
+{
+    BL_PROFILE("DistributionMapping::ComputeDistributionMappingHaloBytes()");
+
+    AMREX_ASSERT(dm.size() == ba.size());
+
+    Long ncells = 0;
+    std::vector<std::pair<int,Box> > isects;
+    for (int i = 0, N = ba.size(); i < N; ++i)
+    {
+        ba.intersections(amrex::grow(ba[i],nghost), isects);
+        for (auto const& is : isects) {
+            if (dm[is.first] != dm[i]) {
+                ncells += is.second.numPts();
+            }
+        }
+    }
+    return ncells * ncomp * static_cast<Long>(sizeof(Real));
+}
+
+void
+DistributionMapping::ComputeDistributionMappingNodeHaloBytes (const DistributionMapping& dm,
+                                                              const BoxArray& ba,
+                                                              Long& intra_node_bytes,
+                                                              Long& inter_node_bytes,
+                                                              const IntVect& nghost,
+                                                              int ncomp)
+{
+    BL_PROFILE("DistributionMapping::ComputeDistributionMappingNodeHaloBytes()");
+
+    AMREX_ASSERT(dm.size() == ba.size());
+
+    Long intra = 0, inter = 0;
+    std::vector<std::pair<int,Box> > isects;
+    for (int i = 0, N = ba.size(); i < N; ++i)
+    {
+        const int node = node_of_rank(dm[i]);
+        ba.intersections(amrex::grow(ba[i],nghost), isects);
+        for (auto const& is : isects) {
+            if (dm[is.first] != dm[i]) {
+                if (node_of_rank(dm[is.first]) == node) {
+                    intra += is.second.numPts();
+                } else {
+                    inter += is.second.numPts();
+                }
+            }
+        }
+    }
+    intra_node_bytes = intra * ncomp * static_cast<Long>(sizeof(Real));
+    inter_node_bytes = inter * ncomp * static_cast<Long>(sizeof(Real));
+}
+
 namespace {
 Vector<Long>
 gather_weights (const MultiFab& weight)
@@ -1688,6 +2404,158 @@ DistributionMapping::makeSFC (const Vector<Real>& rcost, const BoxArray& ba, Rea
     return r;
 }
 
+DistributionMapping
+DistributionMapping::makeHilbert (const MultiFab& weight, bool sort)
+{
+    BL_PROFILE("makeHilbert");
+    Vector<Long> cost = gather_weights(weight);
+    int nprocs = ParallelContext::NProcsSub();
+    DistributionMapping r;
+    r.HilbertProcessorMap(weight.boxArray(), cost, nprocs, sort);
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeHilbert (const MultiFab& weight, Real& eff, bool sort)
+{
+    BL_PROFILE("makeHilbert");
+    Vector<Long> cost = gather_weights(weight);
+    int nprocs = ParallelContext::NProcsSub();
+    DistributionMapping r;
+    r.HilbertProcessorMap(weight.boxArray(), cost, nprocs, eff, sort);
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeHilbert (const Vector<Real>& rcost, const BoxArray& ba, bool sort)
+{
+    Real eff;
+    return makeHilbert(rcost, ba, eff, sort);
+}
+
+DistributionMapping
+DistributionMapping::makeHilbert (const Vector<Real>& rcost, const BoxArray& ba, Real& eff, bool sort)
+{
+    BL_PROFILE("makeHilbert");
+
+    DistributionMapping r;
+
+    Vector<Long> cost(rcost.size());
+
+    Real wmax = *std::max_element(rcost.begin(), rcost.end());
+    Real scale = (wmax == 0) ? 1.e9_rt : 1.e9_rt/wmax;
+
+    for (int i = 0; i < rcost.size(); ++i) {
+        cost[i] = Long(rcost[i]*scale) + 1L;
+    }
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.HilbertProcessorMap(ba, cost, nprocs, eff, sort);
+
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const MultiFab& weight, bool sort)
+{
+    BL_PROFILE("makeGraph");
+    Vector<Long> cost = gather_weights(weight);
+    int nprocs = ParallelContext::NProcsSub();
+    DistributionMapping r;
+    r.GraphProcessorMap(weight.boxArray(), cost, nprocs, sort);
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const MultiFab& weight, Real& eff, bool sort)
+{
+    BL_PROFILE("makeGraph");
+    Vector<Long> cost = gather_weights(weight);
+    int nprocs = ParallelContext::NProcsSub();
+    DistributionMapping r;
+    r.GraphProcessorMap(weight.boxArray(), cost, nprocs, eff, sort);
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const Vector<Real>& rcost, const BoxArray& ba, bool sort)
+{
+    Real eff;
+    return makeGraph(rcost, ba, eff, sort);
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const Vector<Real>& rcost, const BoxArray& ba, Real& eff, bool sort)
+{
+    BL_PROFILE("makeGraph");
+
+    DistributionMapping r;
+
+    Vector<Long> cost(rcost.size());
+
+    Real wmax = *std::max_element(rcost.begin(), rcost.end());
+    Real scale = (wmax == 0) ? 1.e9_rt : 1.e9_rt/wmax;
+
+    for (int i = 0; i < rcost.size(); ++i) {
+        cost[i] = Long(rcost[i]*scale) + 1L;
+    }
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.GraphProcessorMap(ba, cost, nprocs, eff, sort);
+
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeNodeAware (const MultiFab& weight)
+{
+    Real eff;
+    return makeNodeAware(weight, eff);
+}
+
+DistributionMapping
+DistributionMapping::makeNodeAware (const MultiFab& weight, Real& eff)
+{
+    BL_PROFILE("makeNodeAware");
+    Vector<Long> cost = gather_weights(weight);
+    int nprocs = ParallelContext::NProcsSub();
+    DistributionMapping r;
+    r.NodeAwareProcessorMap(weight.boxArray(), cost, nprocs, eff);
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeNodeAware (const Vector<Real>& rcost, const BoxArray& ba)
+{
+    Real eff;
+    return makeNodeAware(rcost, ba, eff);
+}
+
+DistributionMapping
+DistributionMapping::makeNodeAware (const Vector<Real>& rcost, const BoxArray& ba, Real& eff)
+{
+    BL_PROFILE("makeNodeAware");
+
+    DistributionMapping r;
+
+    Vector<Long> cost(rcost.size());
+
+    Real wmax = *std::max_element(rcost.begin(), rcost.end());
+    Real scale = (wmax == 0) ? 1.e9_rt : 1.e9_rt/wmax;
+
+    for (int i = 0; i < rcost.size(); ++i) {
+        cost[i] = Long(rcost[i]*scale) + 1L;
+    }
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.NodeAwareProcessorMap(ba, cost, nprocs, eff);
+
+    return r;
+}
+
 DistributionMapping
 DistributionMapping::makeSFC (const LayoutData<Real>& rcost_local,
                               Real& currentEfficiency, Real& proposedEfficiency,
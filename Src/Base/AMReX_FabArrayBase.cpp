@@ -23,6 +23,8 @@
 #endif
 
 #include <algorithm>
+#include <cstddef>
+#include <limits>
 #include <utility>
 
 namespace amrex {
@@ -31,6 +33,8 @@ namespace amrex {
 // Set default values in Initialize()!!!
 //
 int     FabArrayBase::MaxComp;
+bool    FabArrayBase::fb_persistent_requests;
+bool    FabArrayBase::neighbor_collectives;
 
 #if defined(AMREX_USE_GPU)
 
@@ -75,6 +79,7 @@ std::multimap<FabArrayBase::BDKey,FabArrayBase::ParForInfo*> FabArrayBase::m_The
 
 FabArrayBase::CacheStats           FabArrayBase::m_TAC_stats("TileArrayCache");
 FabArrayBase::CacheStats           FabArrayBase::m_FBC_stats("FBCache");
+FabArrayBase::CacheStats           FabArrayBase::m_FBPC_stats("FBPersistentComm");
 FabArrayBase::CacheStats           FabArrayBase::m_CPC_stats("CopyCache");
 FabArrayBase::CacheStats           FabArrayBase::m_FPinfo_stats("FillPatchCache");
 FabArrayBase::CacheStats           FabArrayBase::m_CFinfo_stats("CrseFineCache");
@@ -90,6 +95,45 @@ namespace
 {
     Arena* the_fa_arena = nullptr;
     bool initialized = false;
+#ifdef BL_USE_MPI
+    // Communicator used by the persistent requests of FB, so that their
+    // fixed tags cannot match messages posted with SeqNum tags.
+    MPI_Comm fb_persistent_comm = MPI_COMM_NULL;
+
+    MPI_Request fb_persistent_request (char* buf, std::size_t n, int rank, int tag, bool is_send)
+    {
+        MPI_Datatype datatype;
+        std::size_t count;
+        const int comm_data_type = ParallelDescriptor::select_comm_data_type(n);
+        if (comm_data_type == 1) {
+            datatype = ParallelDescriptor::Mpi_typemap<char>::type();
+            count = n;
+        } else if (comm_data_type == 2) {
+            AMREX_ALWAYS_ASSERT(amrex::is_aligned(buf, alignof(unsigned long long)) &&
+                                (n % sizeof(unsigned long long)) == 0);
+            datatype = ParallelDescriptor::Mpi_typemap<unsigned long long>::type();
+            count = n / sizeof(unsigned long long);
+        } else if (comm_data_type == 3) {
+            AMREX_ALWAYS_ASSERT(amrex::is_aligned(buf, alignof(ParallelDescriptor::lull_t)) &&
+                                (n % sizeof(ParallelDescriptor::lull_t)) == 0);
+            datatype = ParallelDescriptor::Mpi_typemap<ParallelDescriptor::lull_t>::type();
+            count = n / sizeof(ParallelDescriptor::lull_t);
+        } else {
+            amrex::Abort("Message size is too big");
+            return MPI_REQUEST_NULL;
+        }
+
+        MPI_Request req;
+        if (is_send) {
+            BL_MPI_REQUIRE( MPI_Send_init(buf, static_cast<int>(count), datatype, rank, tag,
+                                          fb_persistent_comm, &req) );
+        } else {
+            BL_MPI_REQUIRE( MPI_Recv_init(buf, static_cast<int>(count), datatype, rank, tag,
+                                          fb_persistent_comm, &req) );
+        }
+        return req;
+    }
+#endif
 }
 
 void
@@ -102,6 +146,8 @@ FabArrayBase::Initialize ()
     // Set default values here!!!
     //
     FabArrayBase::MaxComp           = 25;
+    FabArrayBase::fb_persistent_requests = false;
+    FabArrayBase::neighbor_collectives   = false;
 
     ParmParse pp("fabarray");
 
@@ -123,6 +169,14 @@ FabArrayBase::Initialize ()
         MaxComp = 1;
     }
 
+    pp.queryAdd("fb_persistent_requests", FabArrayBase::fb_persistent_requests);
+    pp.queryAdd("neighbor_collectives", FabArrayBase::neighbor_collectives);
+
+#ifdef BL_USE_MPI
+    // Always duplicated so that fb_persistent_requests can be changed at runtime.
+    BL_MPI_REQUIRE( MPI_Comm_dup(ParallelDescriptor::Communicator(), &fb_persistent_comm) );
+#endif
+
 #ifdef AMREX_USE_GPU
     if (ParallelDescriptor::UseGpuAwareMpi()) {
         the_fa_arena = The_Arena();
@@ -144,6 +198,10 @@ FabArrayBase::Initialize ()
                      ([] () -> MemProfiler::MemInfo {
                          return {m_FBC_stats.bytes, m_FBC_stats.bytes_hwm};
                      }));
+    MemProfiler::add(m_FBPC_stats.name, std::function<MemProfiler::MemInfo()>
+                     ([] () -> MemProfiler::MemInfo {
+                         return {m_FBPC_stats.bytes, m_FBPC_stats.bytes_hwm};
+                     }));
     MemProfiler::add(m_CPC_stats.name, std::function<MemProfiler::MemInfo()>
                      ([] () -> MemProfiler::MemInfo {
                          return {m_CPC_stats.bytes, m_CPC_stats.bytes_hwm};
@@ -636,6 +694,93 @@ FabArrayBase::getCPC (const IntVect& dstng, const FabArrayBase& src, const IntVe
 // Some stuff for fill boundary
 //
 
+#ifdef BL_USE_MPI
+FabArrayBase::CommMetaData::GraphComm::~GraphComm ()
+{
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (m_comm != MPI_COMM_NULL && !finalized) {
+        MPI_Comm_free(&m_comm);
+    }
+}
+
+bool
+FabArrayBase::CommMetaData::useNeighborCollectives ()
+{
+    return neighbor_collectives
+        && ParallelContext::CommunicatorSub() == ParallelDescriptor::Communicator()
+        && !Gpu::inGraphRegion();
+}
+
+MPI_Request
+FabArrayBase::CommMetaData::startNeighborAlltoallv (char const* the_send_data,
+                                                    Vector<char*> const& send_data,
+                                                    Vector<std::size_t> const& send_size,
+                                                    char* the_recv_data,
+                                                    Vector<char*> const& recv_data,
+                                                    Vector<std::size_t> const& recv_size) const
+{
+    BL_PROFILE("CommMetaData::startNeighborAlltoallv()");
+
+    if (!m_graph_comm)
+    {
+        BL_PROFILE("CommMetaData::buildGraphComm");
+        // The order of the neighbors is the order of the maps, which is
+        // also the order of the buffers.
+        Vector<int> sources, destinations;
+        sources.reserve(m_RcvTags->size());
+        for (auto const& kv : *m_RcvTags) {
+            sources.push_back(ParallelContext::global_to_local_rank(kv.first));
+        }
+        destinations.reserve(m_SndTags->size());
+        for (auto const& kv : *m_SndTags) {
+            destinations.push_back(ParallelContext::global_to_local_rank(kv.first));
+        }
+        m_graph_comm = std::make_unique<GraphComm>();
+        BL_MPI_REQUIRE( MPI_Dist_graph_create_adjacent(ParallelDescriptor::Communicator(),
+                                                       static_cast<int>(sources.size()),
+                                                       sources.data(), MPI_UNWEIGHTED,
+                                                       static_cast<int>(destinations.size()),
+                                                       destinations.data(),
+                                                       MPI_UNWEIGHTED, MPI_INFO_NULL, 0,
+                                                       &(m_graph_comm->m_comm)) );
+    }
+
+    auto to_int = [] (std::ptrdiff_t n) -> int
+    {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(n <= static_cast<std::ptrdiff_t>(std::numeric_limits<int>::max()),
+                                         "Message is too big for neighbor collectives");
+        return static_cast<int>(n);
+    };
+
+    const int nsnds = send_size.size();
+    Vector<int> send_counts(nsnds, 0), send_displs(nsnds, 0);
+    for (int i = 0; i < nsnds; ++i) {
+        if (send_size[i] > 0) {
+            send_counts[i] = to_int(send_size[i]);
+            send_displs[i] = to_int(send_data[i] - the_send_data);
+        }
+    }
+
+    const int nrcvs = recv_size.size();
+    Vector<int> recv_counts(nrcvs, 0), recv_displs(nrcvs, 0);
+    for (int i = 0; i < nrcvs; ++i) {
+        if (recv_size[i] > 0) {
+            recv_counts[i] = to_int(recv_size[i]);
+            recv_displs[i] = to_int(recv_data[i] - the_recv_data);
+        }
+    }
+
+    MPI_Datatype datatype = ParallelDescriptor::Mpi_typemap<char>::type();
+    MPI_Request req;
+    BL_MPI_REQUIRE( MPI_Ineighbor_alltoallv(the_send_data, send_counts.data(), send_displs.data(),
+                                            datatype, the_recv_data, recv_counts.data(),
+                                            recv_displs.data(), datatype,
+                                            m_graph_comm->m_comm, &req) );
+    return req;
+}
+#endif
+
 FabArrayBase::FB::FB (const FabArrayBase& fa, const IntVect& nghost,
                       bool cross, const Periodicity& period,
                       bool enforce_periodicity_only, bool override_sync,
@@ -1170,7 +1315,146 @@ FabArrayBase::FB::define_os (const FabArrayBase& fa)
 }
 
 FabArrayBase::FB::~FB ()
-{}
+{
+#ifdef BL_USE_MPI
+    for (auto const& pc : m_persistent_comm) {
+#ifdef AMREX_MEM_PROFILING
+        m_FBPC_stats.bytes -= pc->m_bytes;
+#endif
+        m_FBPC_stats.recordErase(pc->m_nuse);
+    }
+#endif
+}
+
+#ifdef BL_USE_MPI
+FabArrayBase::FB::PersistentComm::~PersistentComm ()
+{
+    for (auto& req : m_recv_reqs) {
+        if (req != MPI_REQUEST_NULL) { MPI_Request_free(&req); }
+    }
+    for (auto& req : m_send_reqs) {
+        if (req != MPI_REQUEST_NULL) { MPI_Request_free(&req); }
+    }
+    if (m_the_recv_data) { The_FA_Arena()->free(m_the_recv_data); }
+    if (m_the_send_data) { The_FA_Arena()->free(m_the_send_data); }
+}
+
+bool
+FabArrayBase::FB::usePersistentComm ()
+{
+    return fb_persistent_requests
+        && fb_persistent_comm != MPI_COMM_NULL
+        && ParallelContext::CommunicatorSub() == ParallelDescriptor::Communicator()
+        && !Gpu::inGraphRegion();
+}
+
+FabArrayBase::FB::PersistentComm*
+FabArrayBase::FB::getPersistentComm (std::size_t bytes_per_pt, int tag) const
+{
+    for (auto const& p : m_persistent_comm) {
+        if (p->m_bytes_per_pt == bytes_per_pt) {
+            if (p->m_in_use) {
+                return nullptr;
+            } else {
+                ++(p->m_nuse);
+                m_FBPC_stats.recordUse();
+                return p.get();
+            }
+        }
+    }
+
+    BL_PROFILE("FabArrayBase::FB::getPersistentComm()");
+
+    auto pc = std::make_unique<PersistentComm>();
+    pc->m_bytes_per_pt = bytes_per_pt;
+    pc->m_tag = tag;
+
+    // The layout of the buffers follows PostRcvs and PrepareSendBuffers,
+    // except that the offsets are aligned for any buffer type, because
+    // the same PersistentComm is used by all FabArrays with this FB.
+    Vector<std::size_t> offset;
+    std::size_t total_volume = 0;
+    for (auto const& kv : *m_RcvTags)
+    {
+        std::size_t nbytes = 0;
+        for (auto const& cct : kv.second) {
+            nbytes += cct.dbox.numPts() * bytes_per_pt;
+        }
+        std::size_t acd = ParallelDescriptor::alignof_comm_data(nbytes);
+        nbytes = amrex::aligned_size(acd, nbytes);
+        total_volume = amrex::aligned_size(std::max(alignof(std::max_align_t), acd),
+                                           total_volume);
+        offset.push_back(total_volume);
+        total_volume += nbytes;
+
+        pc->m_recv_from.push_back(kv.first);
+        pc->m_recv_data.push_back(nullptr);
+        pc->m_recv_size.push_back(nbytes);
+        pc->m_recv_reqs.push_back(MPI_REQUEST_NULL);
+    }
+    pc->m_bytes = total_volume;
+
+    if (total_volume > 0) {
+        pc->m_the_recv_data = static_cast<char*>(The_FA_Arena()->alloc(total_volume));
+        for (int i = 0, N = pc->m_recv_from.size(); i < N; ++i) {
+            pc->m_recv_data[i] = pc->m_the_recv_data + offset[i];
+            if (pc->m_recv_size[i] > 0) {
+                const int rank = ParallelContext::global_to_local_rank(pc->m_recv_from[i]);
+                pc->m_recv_reqs[i] = fb_persistent_request(pc->m_recv_data[i], pc->m_recv_size[i],
+                                                           rank, tag, false);
+            }
+        }
+    }
+
+    offset.clear();
+    total_volume = 0;
+    Vector<int> send_rank;
+    for (auto const& kv : *m_SndTags)
+    {
+        std::size_t nbytes = 0;
+        for (auto const& cct : kv.second) {
+            nbytes += cct.sbox.numPts() * bytes_per_pt;
+        }
+        std::size_t acd = ParallelDescriptor::alignof_comm_data(nbytes);
+        nbytes = amrex::aligned_size(acd, nbytes);
+        total_volume = amrex::aligned_size(std::max(alignof(std::max_align_t), acd),
+                                           total_volume);
+        offset.push_back(total_volume);
+        total_volume += nbytes;
+
+        send_rank.push_back(kv.first);
+        pc->m_send_data.push_back(nullptr);
+        pc->m_send_size.push_back(nbytes);
+        pc->m_send_reqs.push_back(MPI_REQUEST_NULL);
+        pc->m_send_cctc.push_back(&kv.second);
+    }
+    pc->m_bytes += total_volume;
+
+    if (total_volume > 0) {
+        pc->m_the_send_data = static_cast<char*>(The_FA_Arena()->alloc(total_volume));
+        for (int i = 0, N = send_rank.size(); i < N; ++i) {
+            pc->m_send_data[i] = pc->m_the_send_data + offset[i];
+            if (pc->m_send_size[i] > 0) {
+                const int rank = ParallelContext::global_to_local_rank(send_rank[i]);
+                pc->m_send_reqs[i] = fb_persistent_request(pc->m_send_data[i], pc->m_send_size[i],
+                                                           rank, tag, true);
+            }
+        }
+    }
+
+#ifdef AMREX_MEM_PROFILING
+    m_FBPC_stats.bytes += pc->m_bytes;
+    m_FBPC_stats.bytes_hwm = std::max(m_FBPC_stats.bytes_hwm, m_FBPC_stats.bytes);
+#endif
+
+    pc->m_nuse = 1;
+    m_FBPC_stats.recordBuild();
+    m_FBPC_stats.recordUse();
+
+    m_persistent_comm.push_back(std::move(pc));
+    return m_persistent_comm.back().get();
+}
+#endif
 
 void
 FabArrayBase::flushFB (bool no_assertion) const
@@ -2215,10 +2499,19 @@ FabArrayBase::Finalize ()
     FabArrayBase::flushParForCache();
 #endif
 
+#ifdef BL_USE_MPI
+    if (fb_persistent_comm != MPI_COMM_NULL) {
+        BL_MPI_REQUIRE( MPI_Comm_free(&fb_persistent_comm) );
+    }
+#endif
+
     if (ParallelDescriptor::IOProcessor() && amrex::system::verbose > 1) {
         m_FA_stats.print();
         m_TAC_stats.print();
         m_FBC_stats.print();
+        if (fb_persistent_requests) {
+            m_FBPC_stats.print();
+        }
         m_CPC_stats.print();
         m_FPinfo_stats.print();
         m_CFinfo_stats.print();
@@ -2231,6 +2524,7 @@ FabArrayBase::Finalize ()
 
     m_TAC_stats = CacheStats("TileArrayCache");
     m_FBC_stats = CacheStats("FBCache");
+    m_FBPC_stats = CacheStats("FBPersistentComm");
     m_CPC_stats = CacheStats("CopyCache");
     m_FPinfo_stats = CacheStats("FillPatchCache");
     m_CFinfo_stats = CacheStats("CrseFineCache");
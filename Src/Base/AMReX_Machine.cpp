@@ -2,9 +2,16 @@
 
 #ifndef AMREX_USE_MPI
 
+#include <AMReX_Machine.H>
+
 namespace amrex {
 namespace machine {
     void Initialize () {}
+
+    const Vector<int>& shared_memory_node_ids () {
+        static const Vector<int> ids(1, 0);
+        return ids;
+    }
 }}
 
 #else
@@ -217,8 +224,11 @@ class Machine
         get_params();
         get_machine_envs();
         node_ids = get_node_ids();
+        shm_node_ids = get_shared_memory_node_ids();
     }
 
+    const Vector<int>& shared_memory_node_ids () const { return shm_node_ids; }
+
     // find a compact neighborhood of size rank_n in the current ParallelContext subgroup
     Vector<int> find_best_nbh (int nbh_rank_n, bool flag_local_ranks)
     {
@@ -323,6 +333,7 @@ class Machine
     bool flag_nersc_df;
     // int my_node_id;
     Vector<int> node_ids;
+    Vector<int> shm_node_ids;
 
     NeighborhoodCache nbh_cache;
 
@@ -431,6 +442,33 @@ class Machine
         return ids;
     }
 
+    // get the shared memory node of all ranks in this job, indexed by job rank
+    // this is collective over ALL ranks in the job
+    Vector<int> get_shared_memory_node_ids ()
+    {
+        MPI_Comm node_comm;
+        MPI_Comm_split_type(ParallelContext::CommunicatorAll(), MPI_COMM_TYPE_SHARED, 0,
+                            MPI_INFO_NULL, &node_comm);
+        int leader = ParallelDescriptor::MyProc();
+        MPI_Allreduce(MPI_IN_PLACE, &leader, 1, MPI_INT, MPI_MIN, node_comm);
+        MPI_Comm_free(&node_comm);
+
+        const int nprocs = ParallelDescriptor::NProcs();
+        Vector<int> leaders(nprocs);
+        ParallelAllGather::AllGather(leader, leaders.data(), ParallelContext::CommunicatorAll());
+
+        // The leader is the lowest rank on the node.
+        Vector<int> ids(nprocs);
+        int nnodes = 0;
+        for (int i = 0; i < nprocs; ++i) {
+            ids[i] = (leaders[i] == i) ? nnodes++ : ids[leaders[i]];
+        }
+        if (flag_verbose) {
+            Print() << "Machine: " << nnodes << " shared memory nodes" << std::endl;
+        }
+        return ids;
+    }
+
     // do a local search starting at current node
     std::pair<Vector<int>, double>
     baseline_score(const Vector<int> & sg_node_ids, int nbh_rank_n)
@@ -590,6 +628,11 @@ void Finalize () {
     the_machine.reset();
 }
 
+const Vector<int>& shared_memory_node_ids () {
+    AMREX_ASSERT(the_machine);
+    return the_machine->shared_memory_node_ids();
+}
+
 Vector<int> find_best_nbh (int rank_n, bool flag_local_ranks) {
     AMREX_ASSERT(the_machine);
     return the_machine->find_best_nbh(rank_n, flag_local_ranks);
@@ -6,7 +6,9 @@
 #include <AMReX_VisMF.H>
 
 #include <cerrno>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <limits>
 
 namespace amrex {
@@ -28,6 +30,7 @@ bool VisMF::usePersistentIFStreams(false);
 bool VisMF::useSynchronousReads(false);
 bool VisMF::useDynamicSetSelection(true);
 bool VisMF::allowSparseWrites(true);
+std::string VisMF::compression("none");
 
 Long VisMFBuffer::ioBufferSize(VisMF::IO_Buffer_Size);
 
@@ -76,6 +79,8 @@ VisMF::Initialize ()
     pp.queryAdd("usedynamicsetselection", useDynamicSetSelection);
     pp.queryAdd("iobuffersize", ioBufferSize);
     pp.queryAdd("allowsparsewrites", allowSparseWrites);
+    pp.queryAdd("compression", compression);
+    VisMFCodec::Get(compression);  // ---- abort now if the codec does not exist
 
     initialized = true;
 }
@@ -273,8 +278,9 @@ operator<< (std::ostream        &os,
 
     os << hd.m_fod      << '\n';
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(hd.m_vers == VisMF::Header::Version_v1           ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       os << hd.m_min      << '\n';
       os << hd.m_max      << '\n';
@@ -293,9 +299,10 @@ operator<< (std::ostream        &os,
       os << '\n';
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
         os << FPC::NativeRealDescriptor() << '\n';
@@ -306,6 +313,10 @@ operator<< (std::ostream        &os,
       }
     }
 
+    if(hd.m_vers == VisMF::Header::Compressed_v1) {
+      os << hd.m_codec << '\n';
+    }
+
     os.flags(oflags);
     os.precision(oldPrec);
 
@@ -357,8 +368,9 @@ operator>> (std::istream  &is,
     is >> hd.m_fod;
     BL_ASSERT(hd.m_ba.size() == hd.m_fod.size());
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(hd.m_vers == VisMF::Header::Version_v1           ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       is >> hd.m_min;
       is >> hd.m_max;
@@ -383,12 +395,16 @@ operator>> (std::istream  &is,
         }
       }
     }
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       is >> hd.m_writtenRD;
     }
+    if(hd.m_vers == VisMF::Header::Compressed_v1) {
+      is >> hd.m_codec;
+    }
 
 
     if( ! is.good()) {
@@ -929,6 +945,9 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     auto whichRD = FArrayBox::getDataDescriptor();
     bool doConvert(*whichRD != FPC::NativeRealDescriptor());
 
+    const VisMFCodec* codec = VisMFCodec::Get(compression);
+    VisMF::Header::Version whichVersion = (codec) ? VisMF::Header::Compressed_v1 : currentVersion;
+
     if(set_ghost && mf.nGrowVect() != 0) {
         FabArray<FArrayBox>* the_mf = const_cast<FabArray<FArrayBox>*>(&mf);
 
@@ -959,7 +978,8 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     for(int i(0); i < pmap.size(); ++i) {
       procsWithData.insert(pmap[i]);
     }
-    if(allowSparseWrites && (static_cast<int>(procsWithData.size()) < nOutFiles)) {
+    // ---- the offsets of compressed fabs are gathered for the regular file layout
+    if(allowSparseWrites && ! codec && (static_cast<int>(procsWithData.size()) < nOutFiles)) {
       useSparseFPP = true;
 //      amrex::Print() << "SSSSSSSS:  in VisMF::Write:  useSparseFPP for:  " << mf_name << '\n';
       for(std::set<int>::iterator it = procsWithData.begin(); it != procsWithData.end(); ++it) {
@@ -970,20 +990,27 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     int coordinatorProc(ParallelDescriptor::IOProcessorNumber());
     Long bytesWritten(0);
     bool calcMinMax(false);
-    VisMF::Header hdr(mf, how, currentVersion, calcMinMax);
+    VisMF::Header hdr(mf, how, whichVersion, calcMinMax);
+    if(codec) {
+        hdr.m_codec = codec->name();
+    }
 
     std::string filePrefix(mf_name + FabFileSuffix);
 
     NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
 
-    bool oldHeader(currentVersion == VisMF::Header::Version_v1);
+    bool oldHeader(whichVersion == VisMF::Header::Version_v1);
 
     if(useSparseFPP) {
         nfi.SetSparseFPP(procsWithDataVector);
-    } else if(useDynamicSetSelection) {
+    } else if(useDynamicSetSelection && ! codec) {
         nfi.SetDynamic();
     }
     for( ; nfi.ReadyToWrite(); ++nfi) {
+        if(codec) {
+            bytesWritten += WriteCompressedFabs(mf, nfi, hdr, *codec, *whichRD);
+            continue;
+        }
         // ---- find the total number of bytes including fab headers if needed
         const FABio &fio = FArrayBox::getFABio();
         int whichRDBytes(whichRD->numBytes()), nFABs(0);
@@ -1095,13 +1122,14 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
         coordinatorProc = nfi.CoordinatorProc();
     }
 
-    if(currentVersion == VisMF::Header::Version_v1 ||
-       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+    if(whichVersion == VisMF::Header::Version_v1           ||
+       whichVersion == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       whichVersion == VisMF::Header::Compressed_v1)
     {
         hdr.CalculateMinMax(mf, coordinatorProc);
     }
 
-    VisMF::FindOffsets(mf, filePrefix, hdr, currentVersion, nfi,
+    VisMF::FindOffsets(mf, filePrefix, hdr, whichVersion, nfi,
                        ParallelDescriptor::Communicator());
 
     bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
@@ -1110,6 +1138,56 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 }
 
 
+Long
+VisMF::WriteCompressedFabs (const FabArray<FArrayBox>& mf, NFilesIter& nfi,
+                            VisMF::Header& hdr, const VisMFCodec& codec,
+                            const RealDescriptor& whichRD)
+{
+    // ---- each fab is written as an int64 with the number of compressed
+    // ---- bytes followed by the compressed data of all its components
+    bool doConvert(whichRD != FPC::NativeRealDescriptor());
+    int whichRDBytes(whichRD.numBytes());
+    Long bytesWritten(0);
+    Vector<char> convertedData, compressedData;
+
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const FArrayBox &fab = mf[mfi];
+        Long writeDataItems(fab.box().numPts() * mf.nComp());
+        Long writeDataSize(writeDataItems * whichRDBytes);
+        Real const* fabdata = fab.dataPtr();
+#ifdef AMREX_USE_GPU
+        std::unique_ptr<FArrayBox> hostfab;
+        if (fab.arena()->isManaged() || fab.arena()->isDevice()) {
+            hostfab = std::make_unique<FArrayBox>(fab.box(), fab.nComp(),
+                                                  The_Pinned_Arena());
+            Gpu::dtoh_memcpy_async(hostfab->dataPtr(), fab.dataPtr(),
+                                   fab.size()*sizeof(Real));
+            Gpu::streamSynchronize();
+            fabdata = hostfab->dataPtr();
+        }
+#endif
+        const char *rawData = reinterpret_cast<const char *>(fabdata);
+        if(doConvert) {
+            convertedData.resize(writeDataSize);
+            RealDescriptor::convertFromNativeFormat(static_cast<void *> (convertedData.data()),
+                                                    writeDataItems, fabdata, whichRD);
+            rawData = convertedData.data();
+        }
+        codec.compress(rawData, writeDataSize, whichRDBytes, compressedData);
+
+        std::int64_t nBytes(compressedData.size());
+        hdr.m_fod[mfi.index()].m_name = VisMF::BaseName(nfi.FileName());
+        hdr.m_fod[mfi.index()].m_head = VisMF::FileOffset(nfi.Stream());
+        nfi.Stream().write((const char *) &nBytes, sizeof(nBytes));
+        nfi.Stream().write(compressedData.data(), nBytes);
+        nfi.Stream().flush();
+        bytesWritten += sizeof(nBytes) + nBytes;
+    }
+
+    return bytesWritten;
+}
+
+
 Long
 VisMF::WriteOnlyHeader (const FabArray<FArrayBox> & mf,
                         const std::string         & mf_name,
@@ -1160,8 +1238,10 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
       coordinatorProc = nfi.CoordinatorProc();
     }
 
+    // ---- the size of compressed fabs is only known where they are written
     if(FArrayBox::getFormat() == FABio::FAB_ASCII ||
-       FArrayBox::getFormat() == FABio::FAB_8BIT)
+       FArrayBox::getFormat() == FABio::FAB_8BIT  ||
+       hdr.m_vers == VisMF::Header::Compressed_v1)
     {
 
 #ifdef BL_USE_MPI
@@ -1366,6 +1446,43 @@ VisMF::~VisMF ()
 }
 
 
+namespace {
+
+// ---- read a fab written with VisMF::WriteCompressedFabs and convert
+// ---- ncomp components starting at icomp to the native format
+void
+readCompressedFabData (std::istream &is, const VisMF::Header &hdr, Long npts,
+                       int icomp, int ncomp, Real *fabdata)
+{
+    const VisMFCodec *codec = VisMFCodec::Get(hdr.m_codec);
+    if(codec == nullptr) {
+        amrex::Error("VisMF::readFAB:  no codec for Compressed_v1 data");
+    }
+    int rdBytes(hdr.m_writtenRD.numBytes());
+
+    std::int64_t nBytes(0);
+    is.read((char *) &nBytes, sizeof(nBytes));
+    Vector<char> compressedData(nBytes);
+    is.read(compressedData.data(), nBytes);
+    if( ! is.good()) {
+        amrex::Error("VisMF::readFAB:  failed to read compressed data");
+    }
+
+    Vector<char> data(npts * hdr.m_ncomp * rdBytes);
+    codec->decompress(compressedData.data(), nBytes, rdBytes, data.data(), data.size());
+
+    char *compData = data.data() + npts * icomp * rdBytes;
+    if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
+        std::memcpy(fabdata, compData, npts * ncomp * rdBytes);
+    } else {
+        RealDescriptor::convertToNativeFormat(fabdata, npts * ncomp, compData,
+                                              hdr.m_writtenRD);
+    }
+}
+
+}
+
+
 FArrayBox*
 VisMF::readFAB (int                  idx,
                 const std::string   &mf_name,
@@ -1401,7 +1518,10 @@ VisMF::readFAB (int                  idx,
           fabdata = hostfab->dataPtr();
       }
 #endif
-      if(whichComp == -1) {    // ---- read all components
+      if(hdr.m_vers == Header::Compressed_v1) {
+        readCompressedFabData(*infs, hdr, fab->box().numPts(),
+                              whichComp == -1 ? 0 : whichComp, fab->nComp(), fabdata);
+      } else if(whichComp == -1) {    // ---- read all components
         if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
           infs->read((char *) fabdata, fab->nBytes());
         } else {
@@ -1450,7 +1570,7 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(NoFabHeader(hdr)) {
+    if(NoFabHeader(hdr) || hdr.m_vers == VisMF::Header::Compressed_v1) {
       Real* fabdata = fab.dataPtr();
 #ifdef AMREX_USE_GPU
       std::unique_ptr<FArrayBox> hostfab;
@@ -1459,7 +1579,9 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
           fabdata = hostfab->dataPtr();
       }
 #endif
-      if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
+      if(hdr.m_vers == VisMF::Header::Compressed_v1) {
+        readCompressedFabData(*infs, hdr, fab.box().numPts(), 0, fab.nComp(), fabdata);
+      } else if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
         infs->read((char *) fabdata, fab.nBytes());
       } else {
         Long readDataItems(fab.box().numPts() * fab.nComp());
@@ -2104,7 +2226,7 @@ void
 VisMF::clear (int fabIndex)
 {
     for(int ncomp(0), N(m_pa.size()); ncomp < N; ++ncomp) {
-        clear(ncomp, fabIndex);
+        clear(fabIndex, ncomp);
     }
 }
 
@@ -2113,7 +2235,7 @@ VisMF::clear ()
 {
     for(int ncomp(0), N(m_pa.size()); ncomp < N; ++ncomp) {
         for(int fabIndex(0), M(m_pa[ncomp].size()); fabIndex < M; ++fabIndex) {
-            clear(ncomp, fabIndex);
+            clear(fabIndex, ncomp);
         }
     }
 }
@@ -2332,6 +2454,14 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
     }
 #endif
 
+    // The staged copies are held until the job is done.
+    Long staging_bytes = 0;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        Box bx = strip_ghost ? mfi.validbox() : mfi.fabbox();
+        staging_bytes += bx.numPts() * ncomp * static_cast<Long>(sizeof(Real));
+    }
+    AsyncOut::ReserveStaging(staging_bytes);
+
     auto myfabs = std::make_shared<Vector<FArrayBox> >();
     for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
         Box bx = strip_ghost ? mfi.validbox() : mfi.fabbox();
@@ -2462,6 +2592,9 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
         }
 
         AsyncOut::Notify();  // Notify others I am done
+
+        myfabs->clear();
+        AsyncOut::ReleaseStaging(staging_bytes);
     });
 }
 
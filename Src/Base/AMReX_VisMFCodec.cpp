@@ -0,0 +1,206 @@
+#include <AMReX_VisMFCodec.H>
+#include <AMReX.H>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+
+namespace amrex {
+
+namespace {
+
+// Byte shuffle followed by LZ77 with 4-byte minimum matches and offsets
+// of up to 65535 bytes.  The compressed stream is a series of sequences,
+// each made of a token byte (literal length in the high four bits, match
+// length minus four in the low four bits, with 15 meaning that more length
+// bytes follow), the literals, and then a two-byte little-endian offset
+// and the rest of the match length.  The last sequence has only literals.
+class ShuffleLZCodec final
+    : public VisMFCodec
+{
+public:
+    std::string name () const override { return "shuffle_lz"; }
+
+    void compress (const char* in, Long nbytes, int elem_size,
+                   Vector<char>& out) const override
+    {
+        Vector<char> shuffled(nbytes);
+        shuffle(in, nbytes, elem_size, shuffled.data());
+        lz_compress(reinterpret_cast<const unsigned char*>(shuffled.data()), nbytes, out);
+    }
+
+    void decompress (const char* in, Long nin, int elem_size,
+                     char* out, Long nbytes) const override
+    {
+        Vector<char> shuffled(nbytes);
+        lz_decompress(reinterpret_cast<const unsigned char*>(in), nin,
+                      reinterpret_cast<unsigned char*>(shuffled.data()), nbytes);
+        unshuffle(shuffled.data(), nbytes, elem_size, out);
+    }
+
+private:
+    static constexpr int min_match = 4;
+    static constexpr int hash_bits = 16;
+    static constexpr Long max_offset = 65535;
+
+    static void shuffle (const char* in, Long nbytes, int s, char* out)
+    {
+        const Long nelems = nbytes / s;
+        for (Long i = 0; i < nelems; ++i) {
+            for (int b = 0; b < s; ++b) {
+                out[b*nelems+i] = in[i*s+b];
+            }
+        }
+        std::memcpy(out+nelems*s, in+nelems*s, nbytes-nelems*s);
+    }
+
+    static void unshuffle (const char* in, Long nbytes, int s, char* out)
+    {
+        const Long nelems = nbytes / s;
+        for (Long i = 0; i < nelems; ++i) {
+            for (int b = 0; b < s; ++b) {
+                out[i*s+b] = in[b*nelems+i];
+            }
+        }
+        std::memcpy(out+nelems*s, in+nelems*s, nbytes-nelems*s);
+    }
+
+    static std::uint32_t read32 (const unsigned char* p)
+    {
+        std::uint32_t r;
+        std::memcpy(&r, p, sizeof(r));
+        return r;
+    }
+
+    static void put_length (Long len, Vector<char>& out)
+    {
+        while (len >= 255) {
+            out.push_back(char(255));
+            len -= 255;
+        }
+        out.push_back(char(len));
+    }
+
+    static void put_sequence (const unsigned char* lit, Long nlit, Long offset, Long mlen,
+                              Vector<char>& out)
+    {
+        const Long mcode = (mlen > 0) ? mlen - min_match : 0;
+        unsigned char token = static_cast<unsigned char>((std::min<Long>(nlit,15) << 4)
+                                                         | std::min<Long>(mcode,15));
+        out.push_back(char(token));
+        if (nlit >= 15) { put_length(nlit-15, out); }
+        out.insert(out.end(), lit, lit+nlit);
+        if (mlen > 0) {
+            out.push_back(char(offset & 0xff));
+            out.push_back(char((offset >> 8) & 0xff));
+            if (mcode >= 15) { put_length(mcode-15, out); }
+        }
+    }
+
+    static void lz_compress (const unsigned char* in, Long n, Vector<char>& out)
+    {
+        out.clear();
+        out.reserve(n + n/255 + 16);
+        Vector<Long> table(Long(1) << hash_bits, -1);
+        Long ip = 0, anchor = 0;
+        while (ip + min_match <= n) {
+            const std::uint32_t seq = read32(in+ip);
+            const std::uint32_t h = (seq * 2654435761U) >> (32-hash_bits);
+            const Long ref = table[h];
+            table[h] = ip;
+            if (ref >= 0 && ip-ref <= max_offset && read32(in+ref) == seq) {
+                Long len = min_match;
+                while (ip+len < n && in[ref+len] == in[ip+len]) { ++len; }
+                put_sequence(in+anchor, ip-anchor, ip-ref, len, out);
+                ip += len;
+                anchor = ip;
+            } else {
+                ++ip;
+            }
+        }
+        put_sequence(in+anchor, n-anchor, 0, 0, out);
+    }
+
+    static Long get_length (const unsigned char*& ip, const unsigned char* iend)
+    {
+        Long len = 0;
+        unsigned char c;
+        do {
+            if (ip >= iend) { amrex::Abort("VisMFCodec: corrupt shuffle_lz data"); }
+            c = *ip++;
+            len += c;
+        } while (c == 255);
+        return len;
+    }
+
+    static void lz_decompress (const unsigned char* ip, Long nin, unsigned char* op, Long n)
+    {
+        const unsigned char* iend = ip + nin;
+        unsigned char* const ostart = op;
+        unsigned char* const oend = op + n;
+        while (true) {
+            if (ip >= iend) { amrex::Abort("VisMFCodec: corrupt shuffle_lz data"); }
+            const unsigned char token = *ip++;
+            Long nlit = token >> 4;
+            if (nlit == 15) { nlit += get_length(ip, iend); }
+            if (nlit > iend-ip || nlit > oend-op) {
+                amrex::Abort("VisMFCodec: corrupt shuffle_lz data");
+            }
+            std::memcpy(op, ip, nlit);
+            ip += nlit;
+            op += nlit;
+            if (ip == iend) { break; }
+
+            if (iend-ip < 2) { amrex::Abort("VisMFCodec: corrupt shuffle_lz data"); }
+            const Long offset = Long(ip[0]) | (Long(ip[1]) << 8);
+            ip += 2;
+            Long mlen = token & 15;
+            if (mlen == 15) { mlen += get_length(ip, iend); }
+            mlen += min_match;
+            if (offset == 0 || offset > op-ostart || mlen > oend-op) {
+                amrex::Abort("VisMFCodec: corrupt shuffle_lz data");
+            }
+            const unsigned char* match = op - offset;
+            for (Long i = 0; i < mlen; ++i) { // The match may overlap the output.
+                op[i] = match[i];
+            }
+            op += mlen;
+        }
+        if (op != oend) { amrex::Abort("VisMFCodec: corrupt shuffle_lz data"); }
+    }
+};
+
+std::map<std::string, std::unique_ptr<VisMFCodec> >& codecs ()
+{
+    static std::map<std::string, std::unique_ptr<VisMFCodec> > the_codecs = [] () {
+        std::map<std::string, std::unique_ptr<VisMFCodec> > r;
+        r["shuffle_lz"] = std::make_unique<ShuffleLZCodec>();
+        return r;
+    }();
+    return the_codecs;
+}
+
+}
+
+void
+VisMFCodec::Register (std::unique_ptr<VisMFCodec> codec)
+{
+    std::string nm = codec->name();
+    codecs()[nm] = std::move(codec);
+}
+
+const VisMFCodec*
+VisMFCodec::Get (const std::string& name)
+{
+    if (name.empty() || name == "none") {
+        return nullptr;
+    }
+    auto it = codecs().find(name);
+    if (it == codecs().end()) {
+        amrex::Abort("VisMFCodec: unknown codec " + name);
+    }
+    return it->second.get();
+}
+
+}
@@ -1,5 +1,11 @@
 #include <AMReX_Parser_Exe.H>
 
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <string>
+#include <utility>
+
 namespace amrex {
 
 static int parser_local_symbol_index (struct parser_symbol* sym, Vector<char*>& local_variables)
@@ -13,13 +19,244 @@ static int parser_local_symbol_index (struct parser_symbol* sym, Vector<char*>&
     }
 }
 
+namespace {
+
+bool parser_cse_equal (struct parser_node const* a, struct parser_node const* b)
+{
+    if (a->type != b->type) { return false; }
+    switch (a->type)
+    {
+    case PARSER_NUMBER:
+    {
+        double va = ((struct parser_number const*)a)->value;
+        double vb = ((struct parser_number const*)b)->value;
+        return std::memcmp(&va, &vb, sizeof(double)) == 0;
+    }
+    case PARSER_SYMBOL:
+        return std::strcmp(((struct parser_symbol const*)a)->name,
+                           ((struct parser_symbol const*)b)->name) == 0;
+    case PARSER_ADD:
+    case PARSER_SUB:
+    case PARSER_MUL:
+    case PARSER_DIV:
+    case PARSER_ADD_PP:
+    case PARSER_SUB_PP:
+    case PARSER_MUL_PP:
+    case PARSER_DIV_PP:
+        return parser_cse_equal(a->l, b->l) && parser_cse_equal(a->r, b->r);
+    case PARSER_NEG:
+    case PARSER_NEG_P:
+        return parser_cse_equal(a->l, b->l);
+    case PARSER_F1:
+        return ((struct parser_f1 const*)a)->ftype == ((struct parser_f1 const*)b)->ftype
+            && parser_cse_equal(((struct parser_f1 const*)a)->l,
+                                ((struct parser_f1 const*)b)->l);
+    case PARSER_F2:
+        return ((struct parser_f2 const*)a)->ftype == ((struct parser_f2 const*)b)->ftype
+            && parser_cse_equal(((struct parser_f2 const*)a)->l,
+                                ((struct parser_f2 const*)b)->l)
+            && parser_cse_equal(((struct parser_f2 const*)a)->r,
+                                ((struct parser_f2 const*)b)->r);
+    case PARSER_ADD_VP:
+    case PARSER_SUB_VP:
+    case PARSER_MUL_VP:
+    case PARSER_DIV_VP:
+        return std::memcmp(&(a->lvp.v), &(b->lvp.v), sizeof(double)) == 0
+            && parser_cse_equal(a->r, b->r);
+    default:
+        return false;
+    }
+}
+
+void parser_cse_locals (struct parser_node const* node, std::set<std::string>& locals)
+{
+    if (node->type == PARSER_LIST) {
+        parser_cse_locals(node->l, locals);
+        parser_cse_locals(node->r, locals);
+    } else if (node->type == PARSER_ASSIGN) {
+        locals.insert(((struct parser_assign const*)node)->s->name);
+    }
+}
+
+bool parser_cse_symbol (struct parser_node const* node, std::set<std::string> const& locals)
+{
+    auto sym = (struct parser_symbol const*)node;
+    return sym->ip >= 0 && locals.count(sym->name) == 0;
+}
+
+// Returns the size of the subtree if it depends on the registered
+// variables only, and -1 otherwise.  Nodes that may be hoisted out are
+// appended to candidates.  Nodes in the branches of if are skipped,
+// because hoisting them would evaluate them unconditionally.
+int parser_cse_collect (struct parser_node* node, std::set<std::string> const& locals,
+                        Vector<std::pair<int,struct parser_node*>>& candidates)
+{
+    int n = -1;
+    switch (node->type)
+    {
+    case PARSER_NUMBER:
+        return 1;
+    case PARSER_SYMBOL:
+        return parser_cse_symbol(node, locals) ? 1 : -1;
+    case PARSER_ADD_VP:
+    case PARSER_SUB_VP:
+    case PARSER_MUL_VP:
+    case PARSER_DIV_VP:
+        return parser_cse_symbol(node->r, locals) ? 1 : -1;
+    case PARSER_NEG_P:
+        return parser_cse_symbol(node->l, locals) ? 1 : -1;
+    case PARSER_ADD_PP:
+    case PARSER_SUB_PP:
+    case PARSER_MUL_PP:
+    case PARSER_DIV_PP:
+        return (parser_cse_symbol(node->l, locals) &&
+                parser_cse_symbol(node->r, locals)) ? 1 : -1;
+    case PARSER_ADD:
+    case PARSER_SUB:
+    case PARSER_MUL:
+    case PARSER_DIV:
+    case PARSER_F2:
+    {
+        // parser_f2 has the same layout as parser_node for l and r.
+        int nl = parser_cse_collect(node->l, locals, candidates);
+        int nr = parser_cse_collect(node->r, locals, candidates);
+        if (nl > 0 && nr > 0) { n = nl + nr + 1; }
+        break;
+    }
+    case PARSER_NEG:
+    {
+        int nl = parser_cse_collect(node->l, locals, candidates);
+        if (nl > 0) { n = nl + 1; }
+        break;
+    }
+    case PARSER_F1:
+    {
+        int nl = parser_cse_collect(((struct parser_f1*)node)->l, locals, candidates);
+        if (nl > 0) { n = nl + 1; }
+        break;
+    }
+    case PARSER_F3:
+        parser_cse_collect(((struct parser_f3*)node)->n1, locals, candidates);
+        return -1;
+    case PARSER_ASSIGN:
+        parser_cse_collect(((struct parser_assign*)node)->v, locals, candidates);
+        return -1;
+    case PARSER_LIST:
+        parser_cse_collect(node->l, locals, candidates);
+        parser_cse_collect(node->r, locals, candidates);
+        return -1;
+    default:
+        return -1;
+    }
+
+    // A single bytecode instruction is not worth a stack slot, but a
+    // function call is.
+    if (n >= 3 || (n == 2 && node->type != PARSER_NEG)) {
+        candidates.emplace_back(n, node);
+    }
+    return n;
+}
+
+void parser_cse_cover (struct parser_node const* node,
+                       std::set<struct parser_node const*>& covered)
+{
+    covered.insert(node);
+    switch (node->type)
+    {
+    case PARSER_ADD:
+    case PARSER_SUB:
+    case PARSER_MUL:
+    case PARSER_DIV:
+    case PARSER_F2:
+        parser_cse_cover(node->l, covered);
+        parser_cse_cover(node->r, covered);
+        break;
+    case PARSER_NEG:
+        parser_cse_cover(node->l, covered);
+        break;
+    case PARSER_F1:
+        parser_cse_cover(((struct parser_f1 const*)node)->l, covered);
+        break;
+    default:
+        break;
+    }
+}
+
+}
+
+void
+parser_ast_find_cse (struct parser_node* node, ParserCSE& cse)
+{
+    cse.nodes.clear();
+    cse.index.clear();
+
+    std::set<std::string> locals;
+    parser_cse_locals(node, locals);
+
+    Vector<std::pair<int,struct parser_node*>> candidates;
+    parser_cse_collect(node, locals, candidates);
+
+    // Larger subexpressions first.  Identical subexpressions have the
+    // same size, and the ones nested inside a hoisted subexpression are
+    // evaluated only once anyway.
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [] (auto const& a, auto const& b) { return a.first > b.first; });
+
+    std::set<struct parser_node const*> covered;
+    for (int i = 0, ncand = static_cast<int>(candidates.size()); i < ncand; ++i) {
+        auto* a = candidates[i].second;
+        if (covered.count(a)) { continue; }
+        for (int j = i+1; j < ncand && candidates[j].first == candidates[i].first; ++j) {
+            auto* b = candidates[j].second;
+            if (covered.count(b) == 0 && parser_cse_equal(a, b)) {
+                if (covered.count(a) == 0) {
+                    cse.index[a] = static_cast<int>(cse.nodes.size());
+                    cse.nodes.push_back(a);
+                    parser_cse_cover(a, covered);
+                }
+                cse.index[b] = cse.index[a];
+                parser_cse_cover(b, covered);
+            }
+        }
+    }
+}
+
+void
+parser_compile_cse (ParserCSE const& cse, char*& p, std::size_t& exe_size,
+                    int& max_stack_size, int& stack_size, Vector<char*>& local_variables)
+{
+    // Not a valid variable name, so it cannot shadow any symbol.
+    static char cse_name[] = "@cse";
+    for (auto* node : cse.nodes) {
+        parser_compile_exe_size(node, p, exe_size, max_stack_size, stack_size,
+                                local_variables, nullptr);
+        local_variables.push_back(cse_name);
+    }
+}
+
 void
 parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_size,
-                         int& max_stack_size, int& stack_size, Vector<char*>& local_variables)
+                         int& max_stack_size, int& stack_size, Vector<char*>& local_variables,
+                         ParserCSE const* cse)
 {
     // In parser_exe_eval, we push to the stack for NUMBER, SYMBOL, VP, PP, and NEG_P.
     // In parser_exe_eval, we pop the stack for ADD, SUB, MUL, DIV, F2, and IF.
 
+    if (cse) {
+        auto found = cse->index.find(node);
+        if (found != cse->index.end()) {
+            if (p) {
+                auto t = new(p) ParserExeSymbol;
+                p     += sizeof(ParserExeSymbol);
+                t->i = AMREX_PARSER_LOCAL_IDX0 + found->second;
+            }
+            exe_size += sizeof(ParserExeSymbol);
+            ++stack_size;
+            max_stack_size = std::max(max_stack_size, stack_size);
+            return;
+        }
+    }
+
     switch (node->type)
     {
     case PARSER_NUMBER:
@@ -60,7 +297,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         if (node->l->type == PARSER_NUMBER)
         {
             parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeADD_VN;
                 p     += sizeof(ParserExeADD_VN);
@@ -71,7 +308,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->r->type == PARSER_NUMBER)
         {
             parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeADD_VN;
                 p     += sizeof(ParserExeADD_VN);
@@ -82,7 +319,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->l->type == PARSER_SYMBOL)
         {
             parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeADD_PN;
                 p     += sizeof(ParserExeADD_PN);
@@ -103,7 +340,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->r->type == PARSER_SYMBOL)
         {
             parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeADD_PN;
                 p     += sizeof(ParserExeADD_PN);
@@ -127,14 +364,14 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
             int d2 = parser_ast_depth(node->r);
             if (d1 < d2) {
                 parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
             } else {
                 parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
             }
             if (p) {
                 new(p)      ParserExeADD;
@@ -151,7 +388,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         if (node->l->type == PARSER_NUMBER)
         {
             parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeSUB_VN;
                 p     += sizeof(ParserExeSUB_VN);
@@ -162,7 +399,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->r->type == PARSER_NUMBER)
         {
             parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeADD_VN;
                 p     += sizeof(ParserExeADD_VN);
@@ -173,7 +410,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->l->type == PARSER_SYMBOL)
         {
             parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeSUB_PN;
                 p     += sizeof(ParserExeSUB_PN);
@@ -195,7 +432,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->r->type == PARSER_SYMBOL)
         {
             parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeSUB_PN;
                 p     += sizeof(ParserExeSUB_PN);
@@ -220,14 +457,14 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
             int d2 = parser_ast_depth(node->r);
             if (d1 < d2) {
                 parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
             } else {
                 parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
             }
             if (p) {
                 auto t = new(p) ParserExeSUB;
@@ -245,7 +482,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         if (node->l->type == PARSER_NUMBER)
         {
             parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeMUL_VN;
                 p     += sizeof(ParserExeMUL_VN);
@@ -256,7 +493,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->r->type == PARSER_NUMBER)
         {
             parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeMUL_VN;
                 p     += sizeof(ParserExeMUL_VN);
@@ -267,7 +504,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->l->type == PARSER_SYMBOL)
         {
             parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeMUL_PN;
                 p     += sizeof(ParserExeMUL_PN);
@@ -288,7 +525,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->r->type == PARSER_SYMBOL)
         {
             parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeMUL_PN;
                 p     += sizeof(ParserExeMUL_PN);
@@ -312,14 +549,14 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
             int d2 = parser_ast_depth(node->r);
             if (d1 < d2) {
                 parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
             } else {
                 parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
             }
             if (p) {
                 new(p)      ParserExeMUL;
@@ -336,7 +573,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         if (node->l->type == PARSER_NUMBER)
         {
             parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeDIV_VN;
                 p     += sizeof(ParserExeDIV_VN);
@@ -347,7 +584,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->r->type == PARSER_NUMBER)
         {
             parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeMUL_VN;
                 p     += sizeof(ParserExeMUL_VN);
@@ -358,7 +595,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->l->type == PARSER_SYMBOL)
         {
             parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeDIV_PN;
                 p     += sizeof(ParserExeDIV_PN);
@@ -380,7 +617,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         else if (node->r->type == PARSER_SYMBOL)
         {
             parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                    local_variables);
+                                    local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeDIV_PN;
                 p     += sizeof(ParserExeDIV_PN);
@@ -405,9 +642,9 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
             int d2 = parser_ast_depth(node->r);
             if (d1 < d2) {
                 parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 if (p) {
                     new(p)      ParserExeDIV_B;
                     p += sizeof(ParserExeDIV_B);
@@ -415,9 +652,9 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
                 exe_size += sizeof(ParserExeDIV_B);
             } else {
                 parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size,
-                                        local_variables);
+                                        local_variables, cse);
                 if (p) {
                     new(p)      ParserExeDIV_F;
                     p += sizeof(ParserExeDIV_F);
@@ -431,7 +668,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
     }
     case PARSER_NEG:
     {
-        parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size, local_variables);
+        parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size, local_variables, cse);
         if (p) {
             new(p)      ParserExeNEG;
             p += sizeof(ParserExeNEG);
@@ -442,7 +679,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
     case PARSER_F1:
     {
         parser_compile_exe_size(((struct parser_f1*)node)->l,
-                                p, exe_size, max_stack_size, stack_size, local_variables);
+                                p, exe_size, max_stack_size, stack_size, local_variables, cse);
         if (p) {
             auto t = new(p) ParserExeF1;
             p     += sizeof(ParserExeF1);
@@ -457,9 +694,9 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         int d2 = parser_ast_depth(((struct parser_f2*)node)->r);
         if (d1 < d2) {
             parser_compile_exe_size(((struct parser_f2*)node)->r,
-                                    p, exe_size, max_stack_size, stack_size, local_variables);
+                                    p, exe_size, max_stack_size, stack_size, local_variables, cse);
             parser_compile_exe_size(((struct parser_f2*)node)->l,
-                                    p, exe_size, max_stack_size, stack_size, local_variables);
+                                    p, exe_size, max_stack_size, stack_size, local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeF2_B;
                 p     += sizeof(ParserExeF2_B);
@@ -468,9 +705,9 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
             exe_size += sizeof(ParserExeF2_B);
         } else {
             parser_compile_exe_size(((struct parser_f2*)node)->l,
-                                    p, exe_size, max_stack_size, stack_size, local_variables);
+                                    p, exe_size, max_stack_size, stack_size, local_variables, cse);
             parser_compile_exe_size(((struct parser_f2*)node)->r,
-                                    p, exe_size, max_stack_size, stack_size, local_variables);
+                                    p, exe_size, max_stack_size, stack_size, local_variables, cse);
             if (p) {
                 auto t = new(p) ParserExeF2_F;
                 p     += sizeof(ParserExeF2_F);
@@ -486,7 +723,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         AMREX_ALWAYS_ASSERT_WITH_MESSAGE(((struct parser_f3*)node)->ftype == PARSER_IF,
                                          "parser_compile: unknown f3 type");
         parser_compile_exe_size(((struct parser_f3*)node)->n1,
-                                p, exe_size, max_stack_size, stack_size, local_variables);
+                                p, exe_size, max_stack_size, stack_size, local_variables, cse);
 
         ParserExeIF* tif = nullptr;
         char* psave = nullptr;
@@ -500,7 +737,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
         auto stack_size_save = stack_size;
 
         parser_compile_exe_size(((struct parser_f3*)node)->n2,
-                                p, exe_size, max_stack_size, stack_size, local_variables);
+                                p, exe_size, max_stack_size, stack_size, local_variables, cse);
 
         ParserExeJUMP* tjump = nullptr;
         if (p) {
@@ -516,7 +753,7 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
 
         psave = p;
         parser_compile_exe_size(((struct parser_f3*)node)->n3,
-                                p, exe_size, max_stack_size, stack_size, local_variables);
+                                p, exe_size, max_stack_size, stack_size, local_variables, cse);
         if (tjump) {
             tjump->offset = p-psave;
         }
@@ -527,13 +764,13 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
     {
         auto asgn = (struct parser_assign*)node;
         local_variables.push_back(asgn->s->name);
-        parser_compile_exe_size(asgn->v, p, exe_size, max_stack_size, stack_size, local_variables);
+        parser_compile_exe_size(asgn->v, p, exe_size, max_stack_size, stack_size, local_variables, cse);
         break;
     }
     case PARSER_LIST:
     {
-        parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size, local_variables);
-        parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size, local_variables);
+        parser_compile_exe_size(node->l, p, exe_size, max_stack_size, stack_size, local_variables, cse);
+        parser_compile_exe_size(node->r, p, exe_size, max_stack_size, stack_size, local_variables, cse);
         break;
     }
     case PARSER_ADD_VP:
@@ -742,4 +979,398 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
     }
 }
 
+namespace {
+
+void parser_call_f1_batch (enum parser_f1_t type, double* AMREX_RESTRICT a, int n)
+{
+    // The common functions get their own loops so that they can be vectorized.
+    switch (type) {
+    case PARSER_SQRT:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = std::sqrt(a[m]); }
+        break;
+    case PARSER_EXP:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = std::exp(a[m]); }
+        break;
+    case PARSER_LOG:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = std::log(a[m]); }
+        break;
+    case PARSER_SIN:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = std::sin(a[m]); }
+        break;
+    case PARSER_COS:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = std::cos(a[m]); }
+        break;
+    case PARSER_ABS:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = std::abs(a[m]); }
+        break;
+    case PARSER_POW_M3:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = 1.0/(a[m]*a[m]*a[m]); }
+        break;
+    case PARSER_POW_M2:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = 1.0/(a[m]*a[m]); }
+        break;
+    case PARSER_POW_M1:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = 1.0/a[m]; }
+        break;
+    case PARSER_POW_P1:
+        break;
+    case PARSER_POW_P2:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = a[m]*a[m]; }
+        break;
+    case PARSER_POW_P3:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) { a[m] = a[m]*a[m]*a[m]; }
+        break;
+    default:
+        for (int m = 0; m < n; ++m) { a[m] = parser_call_f1(type, a[m]); }
+    }
+}
+
+// a[m] = f(a[m],b[m]) if forward, and f(b[m],a[m]) otherwise.
+void parser_call_f2_batch (enum parser_f2_t type, double* AMREX_RESTRICT a,
+                           double const* AMREX_RESTRICT b, int n, bool forward)
+{
+    switch (type) {
+    case PARSER_MIN:
+    case PARSER_MAX:
+    case PARSER_GT:
+    case PARSER_LT:
+    case PARSER_GEQ:
+    case PARSER_LEQ:
+    case PARSER_EQ:
+    case PARSER_NEQ:
+    case PARSER_AND:
+    case PARSER_OR:
+        AMREX_PRAGMA_SIMD
+        for (int m = 0; m < n; ++m) {
+            a[m] = forward ? parser_call_f2(type,a[m],b[m]) : parser_call_f2(type,b[m],a[m]);
+        }
+        break;
+    default:
+        for (int m = 0; m < n; ++m) {
+            a[m] = forward ? parser_call_f2(type,a[m],b[m]) : parser_call_f2(type,b[m],a[m]);
+        }
+    }
+}
+
+}
+
+bool parser_exe_eval_batch (char const* p, double const* x, int n, double* r)
+{
+    constexpr int B = AMREX_PARSER_BATCH_SIZE;
+    AMREX_ASSERT(n <= B);
+
+    alignas(64) double pstack[AMREX_PARSER_STACK_SIZE][B];
+    int sp = 0; // number of rows in use
+
+    auto get_data = [&] (int i) -> double const* {
+        return (i >= AMREX_PARSER_LOCAL_IDX0) ? pstack[i-AMREX_PARSER_LOCAL_IDX0] : x + i*B;
+    };
+
+    while (*((parser_exe_t const*)p) != PARSER_EXE_NULL) {
+        switch (*((parser_exe_t const*)p))
+        {
+        case PARSER_EXE_NUMBER:
+        {
+            double v = ((ParserExeNumber const*)p)->v;
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = v; }
+            p += sizeof(ParserExeNumber);
+            break;
+        }
+        case PARSER_EXE_SYMBOL:
+        {
+            double const* AMREX_RESTRICT d = get_data(((ParserExeSymbol const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = d[m]; }
+            p += sizeof(ParserExeSymbol);
+            break;
+        }
+        case PARSER_EXE_ADD:
+        {
+            double const* AMREX_RESTRICT b = pstack[--sp];
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] += b[m]; }
+            p += sizeof(ParserExeADD);
+            break;
+        }
+        case PARSER_EXE_SUB:
+        {
+            double sign = ((ParserExeSUB const*)p)->sign;
+            double const* AMREX_RESTRICT b = pstack[--sp];
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = (a[m] - b[m]) * sign; }
+            p += sizeof(ParserExeSUB);
+            break;
+        }
+        case PARSER_EXE_MUL:
+        {
+            double const* AMREX_RESTRICT b = pstack[--sp];
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] *= b[m]; }
+            p += sizeof(ParserExeMUL);
+            break;
+        }
+        case PARSER_EXE_DIV_F:
+        {
+            double const* AMREX_RESTRICT b = pstack[--sp];
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] /= b[m]; }
+            p += sizeof(ParserExeDIV_F);
+            break;
+        }
+        case PARSER_EXE_DIV_B:
+        {
+            double const* AMREX_RESTRICT b = pstack[--sp];
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = b[m] / a[m]; }
+            p += sizeof(ParserExeDIV_B);
+            break;
+        }
+        case PARSER_EXE_NEG:
+        {
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = -a[m]; }
+            p += sizeof(ParserExeNEG);
+            break;
+        }
+        case PARSER_EXE_F1:
+        {
+            parser_call_f1_batch(((ParserExeF1 const*)p)->ftype, pstack[sp-1], n);
+            p += sizeof(ParserExeF1);
+            break;
+        }
+        case PARSER_EXE_F2_F:
+        {
+            --sp;
+            parser_call_f2_batch(((ParserExeF2_F const*)p)->ftype, pstack[sp-1], pstack[sp],
+                                 n, true);
+            p += sizeof(ParserExeF2_F);
+            break;
+        }
+        case PARSER_EXE_F2_B:
+        {
+            --sp;
+            parser_call_f2_batch(((ParserExeF2_B const*)p)->ftype, pstack[sp-1], pstack[sp],
+                                 n, false);
+            p += sizeof(ParserExeF2_B);
+            break;
+        }
+        case PARSER_EXE_ADD_VP:
+        {
+            double v = ((ParserExeADD_VP const*)p)->v;
+            double const* AMREX_RESTRICT d = get_data(((ParserExeADD_VP const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = v + d[m]; }
+            p += sizeof(ParserExeADD_VP);
+            break;
+        }
+        case PARSER_EXE_SUB_VP:
+        {
+            double v = ((ParserExeSUB_VP const*)p)->v;
+            double const* AMREX_RESTRICT d = get_data(((ParserExeSUB_VP const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = v - d[m]; }
+            p += sizeof(ParserExeSUB_VP);
+            break;
+        }
+        case PARSER_EXE_MUL_VP:
+        {
+            double v = ((ParserExeMUL_VP const*)p)->v;
+            double const* AMREX_RESTRICT d = get_data(((ParserExeMUL_VP const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = v * d[m]; }
+            p += sizeof(ParserExeMUL_VP);
+            break;
+        }
+        case PARSER_EXE_DIV_VP:
+        {
+            double v = ((ParserExeDIV_VP const*)p)->v;
+            double const* AMREX_RESTRICT d = get_data(((ParserExeDIV_VP const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = v / d[m]; }
+            p += sizeof(ParserExeDIV_VP);
+            break;
+        }
+        case PARSER_EXE_ADD_PP:
+        {
+            double const* AMREX_RESTRICT d1 = get_data(((ParserExeADD_PP const*)p)->i1);
+            double const* AMREX_RESTRICT d2 = get_data(((ParserExeADD_PP const*)p)->i2);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = d1[m] + d2[m]; }
+            p += sizeof(ParserExeADD_PP);
+            break;
+        }
+        case PARSER_EXE_SUB_PP:
+        {
+            double const* AMREX_RESTRICT d1 = get_data(((ParserExeSUB_PP const*)p)->i1);
+            double const* AMREX_RESTRICT d2 = get_data(((ParserExeSUB_PP const*)p)->i2);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = d1[m] - d2[m]; }
+            p += sizeof(ParserExeSUB_PP);
+            break;
+        }
+        case PARSER_EXE_MUL_PP:
+        {
+            double const* AMREX_RESTRICT d1 = get_data(((ParserExeMUL_PP const*)p)->i1);
+            double const* AMREX_RESTRICT d2 = get_data(((ParserExeMUL_PP const*)p)->i2);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = d1[m] * d2[m]; }
+            p += sizeof(ParserExeMUL_PP);
+            break;
+        }
+        case PARSER_EXE_DIV_PP:
+        {
+            double const* AMREX_RESTRICT d1 = get_data(((ParserExeDIV_PP const*)p)->i1);
+            double const* AMREX_RESTRICT d2 = get_data(((ParserExeDIV_PP const*)p)->i2);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = d1[m] / d2[m]; }
+            p += sizeof(ParserExeDIV_PP);
+            break;
+        }
+        case PARSER_EXE_NEG_P:
+        {
+            double const* AMREX_RESTRICT d = get_data(((ParserExeNEG_P const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = -d[m]; }
+            p += sizeof(ParserExeNEG_P);
+            break;
+        }
+        case PARSER_EXE_ADD_VN:
+        {
+            double v = ((ParserExeADD_VN const*)p)->v;
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] += v; }
+            p += sizeof(ParserExeADD_VN);
+            break;
+        }
+        case PARSER_EXE_SUB_VN:
+        {
+            double v = ((ParserExeSUB_VN const*)p)->v;
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = v - a[m]; }
+            p += sizeof(ParserExeSUB_VN);
+            break;
+        }
+        case PARSER_EXE_MUL_VN:
+        {
+            double v = ((ParserExeMUL_VN const*)p)->v;
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] *= v; }
+            p += sizeof(ParserExeMUL_VN);
+            break;
+        }
+        case PARSER_EXE_DIV_VN:
+        {
+            double v = ((ParserExeDIV_VN const*)p)->v;
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = v / a[m]; }
+            p += sizeof(ParserExeDIV_VN);
+            break;
+        }
+        case PARSER_EXE_ADD_PN:
+        {
+            double const* AMREX_RESTRICT d = get_data(((ParserExeADD_PN const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] += d[m]; }
+            p += sizeof(ParserExeADD_PN);
+            break;
+        }
+        case PARSER_EXE_SUB_PN:
+        {
+            double sign = ((ParserExeSUB_PN const*)p)->sign;
+            double const* AMREX_RESTRICT d = get_data(((ParserExeSUB_PN const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] = (d[m] - a[m]) * sign; }
+            p += sizeof(ParserExeSUB_PN);
+            break;
+        }
+        case PARSER_EXE_MUL_PN:
+        {
+            double const* AMREX_RESTRICT d = get_data(((ParserExeMUL_PN const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int m = 0; m < n; ++m) { a[m] *= d[m]; }
+            p += sizeof(ParserExeMUL_PN);
+            break;
+        }
+        case PARSER_EXE_DIV_PN:
+        {
+            double const* AMREX_RESTRICT d = get_data(((ParserExeDIV_PN const*)p)->i);
+            double* AMREX_RESTRICT a = pstack[sp-1];
+            if (((ParserExeDIV_PN const*)p)->reverse) {
+                AMREX_PRAGMA_SIMD
+                for (int m = 0; m < n; ++m) { a[m] /= d[m]; }
+            } else {
+                AMREX_PRAGMA_SIMD
+                for (int m = 0; m < n; ++m) { a[m] = d[m] / a[m]; }
+            }
+            p += sizeof(ParserExeDIV_PN);
+            break;
+        }
+        case PARSER_EXE_IF:
+        {
+            double const* cond = pstack[--sp];
+            int nfalse = 0;
+            for (int m = 0; m < n; ++m) {
+                if (cond[m] == 0.0) { ++nfalse; }
+            }
+            if (nfalse == n) { // false branch
+                p += ((ParserExeIF const*)p)->offset;
+            } else if (nfalse > 0) { // the points disagree
+                return false;
+            }
+            p += sizeof(ParserExeIF);
+            break;
+        }
+        case PARSER_EXE_JUMP:
+        {
+            int offset = ((ParserExeJUMP const*)p)->offset;
+            p += sizeof(ParserExeJUMP) + offset;
+            break;
+        }
+        default:
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(false,"parser_exe_eval_batch: unknown node type");
+        }
+    }
+
+    double const* AMREX_RESTRICT a = pstack[sp-1];
+    AMREX_PRAGMA_SIMD
+    for (int m = 0; m < n; ++m) { r[m] = a[m]; }
+    return true;
+}
+
 }
@@ -1,7 +1,10 @@
 #include <AMReX_EB_STL_utils.H>
 #include <AMReX_EB_triGeomOps_K.H>
 #include <AMReX_IntConv.H>
+#include <AMReX_ParmParse.H>
+#include <algorithm>
 #include <cstring>
+#include <limits>
 
 namespace amrex
 {
@@ -89,6 +92,85 @@ namespace {
             return std::make_pair(false,0.0_rt);
         }
     }
+
+    // Does line ab intersect with the axis-aligned box [lo,hi]?
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    bool line_box_intersects (Real a[3], Real b[3], XDim3 const& lo, XDim3 const& hi)
+    {
+        Real const blo[] = {lo.x, lo.y, lo.z};
+        Real const bhi[] = {hi.x, hi.y, hi.z};
+        Real tmin = 0._rt;
+        Real tmax = 1._rt;
+        for (int d = 0; d < 3; ++d) {
+            Real dd = b[d] - a[d];
+            if (dd == 0._rt) {
+                if (a[d] < blo[d] || a[d] > bhi[d]) { return false; }
+            } else {
+                Real t1 = (blo[d]-a[d]) / dd;
+                Real t2 = (bhi[d]-a[d]) / dd;
+                tmin = amrex::max(tmin, amrex::min(t1,t2));
+                tmax = amrex::min(tmax, amrex::max(t1,t2));
+                if (tmin > tmax) { return false; }
+            }
+        }
+        return true;
+    }
+
+    // Call f(it) for the triangles that might be relevant.  If bvh is
+    // not null, only triangles in the leaves whose bounding boxes pass
+    // node_test(lo,hi) are visited.  Otherwise, all triangles are
+    // visited.  The loop stops as soon as f returns true.
+    template <typename NT, typename F>
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    void for_each_tri (int num_tri, STLtools::BVHNode const* bvh,
+                       NT const& node_test, F const& f)
+    {
+        if (bvh) {
+            int stack[STLtools::bvh_max_depth];
+            int sp = 0;
+            stack[sp++] = 0;
+            while (sp > 0) {
+                int inode = stack[--sp];
+                auto const& node = bvh[inode];
+                if (node_test(node.boxlo, node.boxhi)) {
+                    if (node.ntri > 0) {
+                        for (int it = node.first; it < node.first+node.ntri; ++it) {
+                            if (f(it)) { return; }
+                        }
+                    } else {
+                        stack[sp++] = node.right;
+                        stack[sp++] = inode+1;
+                    }
+                }
+            }
+        } else {
+            for (int it = 0; it < num_tri; ++it) {
+                if (f(it)) { return; }
+            }
+        }
+    }
+
+    // Number of triangles intersected by line ab
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    int num_line_tri_intersects (Real a[3], Real b[3], int num_tri,
+                                 STLtools::Triangle const* tri_pts,
+                                 STLtools::BVHNode const* bvh)
+    {
+        int num_intersects = 0;
+        for_each_tri(num_tri, bvh,
+                     [&] (XDim3 const& lo, XDim3 const& hi) -> bool
+                     {
+                         return line_box_intersects(a, b, lo, hi);
+                     },
+                     [&] (int it) -> bool
+                     {
+                         if (line_tri_intersects(a, b, tri_pts[it])) {
+                             ++num_intersects;
+                         }
+                         return false;
+                     });
+        return num_intersects;
+    }
 }
 
 void
@@ -242,6 +324,18 @@ STLtools::prepare ()
     if (!ParallelDescriptor::IOProcessor()) {
         m_tri_pts_h.resize(m_num_tri);
     }
+    ParallelDescriptor::Bcast((char*)(m_tri_pts_h.dataPtr()), m_num_tri*sizeof(Triangle));
+
+    {
+        ParmParse pp("eb2");
+        pp.queryAdd("stl_use_bvh", m_use_bvh);
+        pp.queryAdd("stl_bvh_leaf_size", m_bvh_leaf_size);
+        m_bvh_leaf_size = std::max(m_bvh_leaf_size, 1);
+    }
+
+    // The triangles are reordered so that the ones in the same BVH leaf
+    // are contiguous.
+    build_bvh();
 
     //device vectors
     m_tri_pts_d.resize(m_num_tri);
@@ -250,6 +344,10 @@ STLtools::prepare ()
     Gpu::copyAsync(Gpu::hostToDevice, m_tri_pts_h.begin(), m_tri_pts_h.end(),
                    m_tri_pts_d.begin());
 
+    m_bvh_nodes_d.resize(m_bvh_nodes_h.size());
+    Gpu::copyAsync(Gpu::hostToDevice, m_bvh_nodes_h.begin(), m_bvh_nodes_h.end(),
+                   m_bvh_nodes_d.begin());
+
     Triangle const* tri_pts = m_tri_pts_d.data();
     XDim3* tri_norm = m_tri_normals_d.data();
 
@@ -413,6 +511,128 @@ STLtools::prepare ()
     m_boundry_is_outside = num_isects % 2 == 0;
 }
 
+void
+STLtools::build_bvh ()
+{
+    m_bvh_nodes_h.clear();
+    if (!m_use_bvh || m_num_tri == 0) { return; }
+
+    Vector<XDim3> cent(m_num_tri);
+    Vector<int> idx(m_num_tri);
+    XDim3 alo{std::numeric_limits<Real>::max(),
+              std::numeric_limits<Real>::max(),
+              std::numeric_limits<Real>::max()};
+    XDim3 ahi{std::numeric_limits<Real>::lowest(),
+              std::numeric_limits<Real>::lowest(),
+              std::numeric_limits<Real>::lowest()};
+    for (int i = 0; i < m_num_tri; ++i) {
+        Triangle const& tri = m_tri_pts_h[i];
+        cent[i] = XDim3{(tri.v1.x + tri.v2.x + tri.v3.x) / 3._rt,
+                        (tri.v1.y + tri.v2.y + tri.v3.y) / 3._rt,
+                        (tri.v1.z + tri.v2.z + tri.v3.z) / 3._rt};
+        idx[i] = i;
+        alo.x = amrex::min(alo.x, tri.v1.x, tri.v2.x, tri.v3.x);
+        alo.y = amrex::min(alo.y, tri.v1.y, tri.v2.y, tri.v3.y);
+        alo.z = amrex::min(alo.z, tri.v1.z, tri.v2.z, tri.v3.z);
+        ahi.x = amrex::max(ahi.x, tri.v1.x, tri.v2.x, tri.v3.x);
+        ahi.y = amrex::max(ahi.y, tri.v1.y, tri.v2.y, tri.v3.y);
+        ahi.z = amrex::max(ahi.z, tri.v1.z, tri.v2.z, tri.v3.z);
+    }
+
+    // Pad the node boxes so that round-off in the box tests cannot reject
+    // a triangle that the exact triangle tests would accept.
+    const Real pad = Real(100.) * std::numeric_limits<Real>::epsilon()
+        * amrex::max(ahi.x-alo.x, ahi.y-alo.y, ahi.z-alo.z, Real(1.0));
+
+    // Nodes are created in depth-first order.  Because tasks are popped
+    // from the back, the left child is always processed right after its
+    // parent, and the index of the right child is recorded in the parent
+    // when the right child is created.
+    struct Task {
+        int begin, end, parent, depth;
+    };
+    Vector<Task> tasks;
+    tasks.push_back(Task{0, m_num_tri, -1, 0});
+    m_bvh_nodes_h.reserve(2*(m_num_tri/m_bvh_leaf_size+1));
+    int max_depth = 0;
+
+    while (!tasks.empty()) {
+        Task const t = tasks.back();
+        tasks.pop_back();
+
+        const int inode = static_cast<int>(m_bvh_nodes_h.size());
+        m_bvh_nodes_h.push_back(BVHNode{});
+        if (t.parent >= 0) {
+            m_bvh_nodes_h[t.parent].right = inode;
+        }
+        max_depth = std::max(max_depth, t.depth);
+
+        XDim3 lo{std::numeric_limits<Real>::max(),
+                 std::numeric_limits<Real>::max(),
+                 std::numeric_limits<Real>::max()};
+        XDim3 hi{std::numeric_limits<Real>::lowest(),
+                 std::numeric_limits<Real>::lowest(),
+                 std::numeric_limits<Real>::lowest()};
+        XDim3 clo = lo;
+        XDim3 chi = hi;
+        for (int n = t.begin; n < t.end; ++n) {
+            Triangle const& tri = m_tri_pts_h[idx[n]];
+            lo.x = amrex::min(lo.x, tri.v1.x, tri.v2.x, tri.v3.x);
+            lo.y = amrex::min(lo.y, tri.v1.y, tri.v2.y, tri.v3.y);
+            lo.z = amrex::min(lo.z, tri.v1.z, tri.v2.z, tri.v3.z);
+            hi.x = amrex::max(hi.x, tri.v1.x, tri.v2.x, tri.v3.x);
+            hi.y = amrex::max(hi.y, tri.v1.y, tri.v2.y, tri.v3.y);
+            hi.z = amrex::max(hi.z, tri.v1.z, tri.v2.z, tri.v3.z);
+            XDim3 const& c = cent[idx[n]];
+            clo.x = std::min(clo.x, c.x);
+            clo.y = std::min(clo.y, c.y);
+            clo.z = std::min(clo.z, c.z);
+            chi.x = std::max(chi.x, c.x);
+            chi.y = std::max(chi.y, c.y);
+            chi.z = std::max(chi.z, c.z);
+        }
+
+        BVHNode& node = m_bvh_nodes_h[inode];
+        node.boxlo = XDim3{lo.x-pad, lo.y-pad, lo.z-pad};
+        node.boxhi = XDim3{hi.x+pad, hi.y+pad, hi.z+pad};
+
+        // Split at the median centroid along the longest direction.
+        const int ntri = t.end - t.begin;
+        const Real ext[] = {chi.x-clo.x, chi.y-clo.y, chi.z-clo.z};
+        const int dir = (ext[0] >= ext[1] && ext[0] >= ext[2]) ? 0
+            : ((ext[1] >= ext[2]) ? 1 : 2);
+        if (ntri <= m_bvh_leaf_size || ext[dir] <= 0._rt) {
+            node.first = t.begin;
+            node.ntri = ntri;
+        } else {
+            const int mid = t.begin + ntri/2;
+            std::nth_element(idx.begin()+t.begin, idx.begin()+mid, idx.begin()+t.end,
+                             [&] (int a, int b) -> bool
+                             {
+                                 Real const* ca = &(cent[a].x);
+                                 Real const* cb = &(cent[b].x);
+                                 return ca[dir] < cb[dir];
+                             });
+            tasks.push_back(Task{mid, t.end, inode, t.depth+1});
+            tasks.push_back(Task{t.begin, mid, -1, t.depth+1});
+        }
+    }
+
+    // The traversal stack needs at most max_depth+1 entries.
+    AMREX_ALWAYS_ASSERT(max_depth < bvh_max_depth);
+
+    Gpu::PinnedVector<Triangle> tri_pts(m_num_tri);
+    for (int n = 0; n < m_num_tri; ++n) {
+        tri_pts[n] = m_tri_pts_h[idx[n]];
+    }
+    std::swap(m_tri_pts_h, tri_pts);
+
+    if (amrex::Verbose() > 0) {
+        amrex::Print() << "    Number of BVH nodes: " << m_bvh_nodes_h.size()
+                       << ", depth: " << max_depth << "\n";
+    }
+}
+
 void
 STLtools::fill (MultiFab& mf, IntVect const& nghost, Geometry const& geom,
                 Real outside_value, Real inside_value) const
@@ -423,6 +643,7 @@ STLtools::fill (MultiFab& mf, IntVect const& nghost, Geometry const& geom,
     const auto dx  = geom.CellSizeArray();
 
     const Triangle* tri_pts = m_tri_pts_d.data();
+    const BVHNode* bvh = bvh_nodes();
     XDim3 ptmin = m_ptmin;
     XDim3 ptmax = m_ptmax;
     XDim3 ptref = m_ptref;
@@ -447,11 +668,8 @@ STLtools::fill (MultiFab& mf, IntVect const& nghost, Geometry const& geom,
             coords[2] >= ptmin.z && coords[2] <= ptmax.z)
         {
             Real pr[]={ptref.x, ptref.y, ptref.z};
-            for (int tr=0; tr < num_triangles; ++tr) {
-                if (line_tri_intersects(pr, coords, tri_pts[tr])) {
-                    ++num_intersects;
-                }
-            }
+            num_intersects = num_line_tri_intersects(pr, coords, num_triangles,
+                                                     tri_pts, bvh);
         }
         ma[box_no](i,j,k) = (num_intersects % 2 == 0) ? reference_value : other_value;
     });
@@ -491,6 +709,7 @@ STLtools::getBoxType (Box const& box, Geometry const& geom, RunOn) const
     {
         int num_triangles = m_num_tri;
         const Triangle* tri_pts = m_tri_pts_d.data();
+        const BVHNode* bvh = bvh_nodes();
         XDim3 ptmin = m_ptmin;
         XDim3 ptmax = m_ptmax;
         XDim3 ptref = m_ptref;
@@ -517,11 +736,8 @@ STLtools::getBoxType (Box const& box, Geometry const& geom, RunOn) const
                 coords[2] >= ptmin.z && coords[2] <= ptmax.z)
             {
                 Real pr[]={ptref.x, ptref.y, ptref.z};
-                for (int tr=0; tr < num_triangles; ++tr) {
-                    if (line_tri_intersects(pr, coords, tri_pts[tr])) {
-                        ++num_intersects;
-                    }
-                }
+                num_intersects = num_line_tri_intersects(pr, coords, num_triangles,
+                                                         tri_pts, bvh);
             }
 
             return (num_intersects % 2 == 0) ? ref_value : 1-ref_value;
@@ -548,6 +764,7 @@ STLtools::fillFab (BaseFab<Real>& levelset, const Geometry& geom, RunOn, Box con
     const auto dx  = geom.CellSizeArray();
 
     const Triangle* tri_pts = m_tri_pts_d.data();
+    const BVHNode* bvh = bvh_nodes();
     XDim3 ptmin = m_ptmin;
     XDim3 ptmax = m_ptmax;
     XDim3 ptref = m_ptref;
@@ -572,11 +789,8 @@ STLtools::fillFab (BaseFab<Real>& levelset, const Geometry& geom, RunOn, Box con
             coords[2] >= ptmin.z && coords[2] <= ptmax.z)
         {
             Real pr[]={ptref.x, ptref.y, ptref.z};
-            for (int tr=0; tr < num_triangles; ++tr) {
-                if (line_tri_intersects(pr, coords, tri_pts[tr])) {
-                    ++num_intersects;
-                }
-            }
+            num_intersects = num_line_tri_intersects(pr, coords, num_triangles,
+                                                     tri_pts, bvh);
         }
         a(i,j,k) = (num_intersects % 2 == 0) ? reference_value : other_value;
     });
@@ -595,6 +809,7 @@ STLtools::getIntercept (Array<Array4<Real>,AMREX_SPACEDIM> const& inter_arr,
 
     const Triangle* tri_pts = m_tri_pts_d.data();
     const XDim3* tri_norm = m_tri_normals_d.data();
+    const BVHNode* bvh = bvh_nodes();
 
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
         Array4<Real> const& inter = inter_arr[idim];
@@ -614,59 +829,86 @@ STLtools::getIntercept (Array<Array4<Real>,AMREX_SPACEDIM> const& inter_arr,
                 };
                 if (idim == 0) {
                     Real x2 = plo[0]+(i+1)*dx[0];
-                    int it;
-                    for (it=0; it < num_triangles; ++it) {
-                        auto const& tri = tri_pts[it];
-                        auto tmp = edge_tri_intersects(p1.x, x2, p1.y, p1.z,
-                                                       tri.v1, tri.v2, tri.v3,
-                                                       tri_norm[it],
-                                                       lst(i+1,j,k)-lst(i,j,k));
-                        if (tmp.first) {
-                            r = tmp.second;
-                            break;
-                        }
-                    }
-                    if (it == num_triangles) {
+                    bool found = false;
+                    for_each_tri(num_triangles, bvh,
+                        [&] (XDim3 const& lo, XDim3 const& hi) -> bool
+                        {
+                            return !(p1.x > hi.x || x2 < lo.x ||
+                                     p1.y > hi.y || p1.y < lo.y ||
+                                     p1.z > hi.z || p1.z < lo.z);
+                        },
+                        [&] (int it) -> bool
+                        {
+                            auto const& tri = tri_pts[it];
+                            auto tmp = edge_tri_intersects(p1.x, x2, p1.y, p1.z,
+                                                           tri.v1, tri.v2, tri.v3,
+                                                           tri_norm[it],
+                                                           lst(i+1,j,k)-lst(i,j,k));
+                            if (tmp.first) {
+                                r = tmp.second;
+                                found = true;
+                            }
+                            return found;
+                        });
+                    if (!found) {
                         r = (lst(i,j,k) > 0._rt) ? p1.x : x2;
                     }
                 } else if (idim == 1) {
                     Real y2 = plo[1]+(j+1)*dx[1];
-                    int it;
-                    for (it=0; it < num_triangles; ++it) {
-                        auto const& tri = tri_pts[it];
-                        auto const& norm = tri_norm[it];
-                        auto tmp = edge_tri_intersects(p1.y, y2, p1.z, p1.x,
-                                                       {tri.v1.y, tri.v1.z, tri.v1.x},
-                                                       {tri.v2.y, tri.v2.z, tri.v2.x},
-                                                       {tri.v3.y, tri.v3.z, tri.v3.x},
-                                                       {  norm.y,   norm.z,   norm.x},
-                                                       lst(i,j+1,k)-lst(i,j,k));
-                        if (tmp.first) {
-                            r = tmp.second;
-                            break;
-                        }
-                    }
-                    if (it == num_triangles) {
+                    bool found = false;
+                    for_each_tri(num_triangles, bvh,
+                        [&] (XDim3 const& lo, XDim3 const& hi) -> bool
+                        {
+                            return !(p1.y > hi.y || y2 < lo.y ||
+                                     p1.z > hi.z || p1.z < lo.z ||
+                                     p1.x > hi.x || p1.x < lo.x);
+                        },
+                        [&] (int it) -> bool
+                        {
+                            auto const& tri = tri_pts[it];
+                            auto const& norm = tri_norm[it];
+                            auto tmp = edge_tri_intersects(p1.y, y2, p1.z, p1.x,
+                                                           {tri.v1.y, tri.v1.z, tri.v1.x},
+                                                           {tri.v2.y, tri.v2.z, tri.v2.x},
+                                                           {tri.v3.y, tri.v3.z, tri.v3.x},
+                                                           {  norm.y,   norm.z,   norm.x},
+                                                           lst(i,j+1,k)-lst(i,j,k));
+                            if (tmp.first) {
+                                r = tmp.second;
+                                found = true;
+                            }
+                            return found;
+                        });
+                    if (!found) {
                         r = (lst(i,j,k) > 0._rt) ? p1.y : y2;
                     }
                 } else {
                     Real z2 = plo[2]+(k+1)*dx[2];
-                    int it;
-                    for (it=0; it < num_triangles; ++it) {
-                        auto const& tri = tri_pts[it];
-                        auto const& norm = tri_norm[it];
-                        auto tmp = edge_tri_intersects(p1.z, z2, p1.x, p1.y,
-                                                       {tri.v1.z, tri.v1.x, tri.v1.y},
-                                                       {tri.v2.z, tri.v2.x, tri.v2.y},
-                                                       {tri.v3.z, tri.v3.x, tri.v3.y},
-                                                       {  norm.z,   norm.x,   norm.y},
-                                                       lst(i,j,k+1)-lst(i,j,k));
-                        if (tmp.first) {
-                            r = tmp.second;
-                            break;
-                        }
-                    }
-                    if (it == num_triangles) {
+                    bool found = false;
+                    for_each_tri(num_triangles, bvh,
+                        [&] (XDim3 const& lo, XDim3 const& hi) -> bool
+                        {
+                            return !(p1.z > hi.z || z2 < lo.z ||
+                                     p1.x > hi.x || p1.x < lo.x ||
+                                     p1.y > hi.y || p1.y < lo.y);
+                        },
+                        [&] (int it) -> bool
+                        {
+                            auto const& tri = tri_pts[it];
+                            auto const& norm = tri_norm[it];
+                            auto tmp = edge_tri_intersects(p1.z, z2, p1.x, p1.y,
+                                                           {tri.v1.z, tri.v1.x, tri.v1.y},
+                                                           {tri.v2.z, tri.v2.x, tri.v2.y},
+                                                           {tri.v3.z, tri.v3.x, tri.v3.y},
+                                                           {  norm.z,   norm.x,   norm.y},
+                                                           lst(i,j,k+1)-lst(i,j,k));
+                            if (tmp.first) {
+                                r = tmp.second;
+                                found = true;
+                            }
+                            return found;
+                        });
+                    if (!found) {
                         r = (lst(i,j,k) > 0._rt) ? p1.z : z2;
                     }
                 }
@@ -847,6 +847,158 @@ MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
     }
 }
 
+bool
+MLABecLaplacian::supportsMixedPrecision () const
+{
+    if (!isCrossStencil() || isTensorOp() || hasHiddenDimension()) return false;
+    // Semicoarsening needs the line solve.
+    for (auto const& r : mg_coarsen_ratio_vec) {
+        if (r != IntVect(mg_coarsen_ratio)) return false;
+    }
+    for (auto const& osm_amrlev : m_overset_mask) {
+        for (auto const& osm : osm_amrlev) {
+            if (osm) return false;
+        }
+    }
+    return true;
+}
+
+void
+MLABecLaplacian::FapplySingle (int amrlev, int mglev, fMultiFab& out, const fMultiFab& in) const
+{
+    BL_PROFILE("MLABecLaplacian::FapplySingle()");
+
+    const MultiFab& acoef = m_a_coeffs[amrlev][mglev];
+    AMREX_D_TERM(const MultiFab& bxcoef = m_b_coeffs[amrlev][mglev][0];,
+                 const MultiFab& bycoef = m_b_coeffs[amrlev][mglev][1];,
+                 const MultiFab& bzcoef = m_b_coeffs[amrlev][mglev][2];);
+
+    const auto dxinv = m_geom[amrlev][mglev].InvCellSizeArray();
+
+    const Real ascalar = m_a_scalar;
+    const Real bscalar = m_b_scalar;
+
+    const int ncomp = getNComp();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(out, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const auto& xfab = in.const_array(mfi);
+        const auto& yfab = out.array(mfi);
+        const auto& afab = acoef.const_array(mfi);
+        AMREX_D_TERM(const auto& bxfab = bxcoef.const_array(mfi);,
+                     const auto& byfab = bycoef.const_array(mfi);,
+                     const auto& bzfab = bzcoef.const_array(mfi););
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D(bx, ncomp, i, j, k, n,
+        {
+            mlabeclap_adotx(i,j,k,n, yfab, xfab, afab, AMREX_D_DECL(bxfab,byfab,bzfab),
+                            dxinv, ascalar, bscalar);
+        });
+    }
+}
+
+void
+MLABecLaplacian::FsmoothSingle (int amrlev, int mglev, fMultiFab& sol, const fMultiFab& rhs,
+                                int redblack) const
+{
+    BL_PROFILE("MLABecLaplacian::FsmoothSingle()");
+
+    const MultiFab& acoef = m_a_coeffs[amrlev][mglev];
+    AMREX_ALWAYS_ASSERT(acoef.nGrowVect() == 0);
+    AMREX_D_TERM(const MultiFab& bxcoef = m_b_coeffs[amrlev][mglev][0];,
+                 const MultiFab& bycoef = m_b_coeffs[amrlev][mglev][1];,
+                 const MultiFab& bzcoef = m_b_coeffs[amrlev][mglev][2];);
+    const auto& undrrelxr = m_undrrelxr[amrlev][mglev];
+    const auto& maskvals  = m_maskvals [amrlev][mglev];
+
+    OrientationIter oitr;
+
+    const FabSet& f0 = undrrelxr[oitr()]; ++oitr;
+    const FabSet& f1 = undrrelxr[oitr()]; ++oitr;
+#if (AMREX_SPACEDIM > 1)
+    const FabSet& f2 = undrrelxr[oitr()]; ++oitr;
+    const FabSet& f3 = undrrelxr[oitr()]; ++oitr;
+#if (AMREX_SPACEDIM > 2)
+    const FabSet& f4 = undrrelxr[oitr()]; ++oitr;
+    const FabSet& f5 = undrrelxr[oitr()]; ++oitr;
+#endif
+#endif
+
+    const MultiMask& mm0 = maskvals[0];
+    const MultiMask& mm1 = maskvals[1];
+#if (AMREX_SPACEDIM > 1)
+    const MultiMask& mm2 = maskvals[2];
+    const MultiMask& mm3 = maskvals[3];
+#if (AMREX_SPACEDIM > 2)
+    const MultiMask& mm4 = maskvals[4];
+    const MultiMask& mm5 = maskvals[5];
+#endif
+#endif
+
+    const int nc = getNComp();
+    const Real* h = m_geom[amrlev][mglev].CellSize();
+    AMREX_D_TERM(const Real dhx = m_b_scalar/(h[0]*h[0]);,
+                 const Real dhy = m_b_scalar/(h[1]*h[1]);,
+                 const Real dhz = m_b_scalar/(h[2]*h[2]));
+    const Real alpha = m_a_scalar;
+
+    MFItInfo mfi_info;
+    if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling().SetDynamic(true);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(sol,mfi_info); mfi.isValid(); ++mfi)
+    {
+        const auto& m0 = mm0.array(mfi);
+        const auto& m1 = mm1.array(mfi);
+#if (AMREX_SPACEDIM > 1)
+        const auto& m2 = mm2.array(mfi);
+        const auto& m3 = mm3.array(mfi);
+#if (AMREX_SPACEDIM > 2)
+        const auto& m4 = mm4.array(mfi);
+        const auto& m5 = mm5.array(mfi);
+#endif
+#endif
+
+        const Box& tbx = mfi.tilebox();
+        const Box& vbx = mfi.validbox();
+        const auto& solnfab = sol.array(mfi);
+        const auto& rhsfab  = rhs.const_array(mfi);
+        const auto& afab    = acoef.const_array(mfi);
+
+        AMREX_D_TERM(const auto& bxfab = bxcoef.const_array(mfi);,
+                     const auto& byfab = bycoef.const_array(mfi);,
+                     const auto& bzfab = bzcoef.const_array(mfi););
+
+        const auto& f0fab = f0.const_array(mfi);
+        const auto& f1fab = f1.const_array(mfi);
+#if (AMREX_SPACEDIM > 1)
+        const auto& f2fab = f2.const_array(mfi);
+        const auto& f3fab = f3.const_array(mfi);
+#if (AMREX_SPACEDIM > 2)
+        const auto& f4fab = f4.const_array(mfi);
+        const auto& f5fab = f5.const_array(mfi);
+#endif
+#endif
+
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D(tbx, nc, i, j, k, n,
+        {
+            abec_gsrb(i,j,k,n, solnfab, rhsfab, alpha, afab,
+                      AMREX_D_DECL(dhx, dhy, dhz),
+                      AMREX_D_DECL(bxfab, byfab, bzfab),
+                      AMREX_D_DECL(m0,m2,m4),
+                      AMREX_D_DECL(m1,m3,m5),
+                      AMREX_D_DECL(f0fab,f2fab,f4fab),
+                      AMREX_D_DECL(f1fab,f3fab,f5fab),
+                      vbx, redblack);
+        });
+    }
+}
+
 void
 MLABecLaplacian::FFlux (int amrlev, const MFIter& mfi,
                         const Array<FArrayBox*,AMREX_SPACEDIM>& flux,
@@ -49,6 +49,49 @@ sxay (MultiFab&       ss,
     sxay(ss,xx,a,yy,0,nghost);
 }
 
+//! Sum of local values over a communicator that can be overlapped with
+//! other work between the constructor and wait().
+class NonBlockingSum
+{
+public:
+    NonBlockingSum (Real* a_vals, int a_n, MPI_Comm a_comm)
+    {
+#ifdef BL_USE_MPI
+        BL_MPI_REQUIRE( MPI_Iallreduce(MPI_IN_PLACE, a_vals, a_n,
+                                       ParallelDescriptor::Mpi_typemap<Real>::type(),
+                                       MPI_SUM, a_comm, &m_req) );
+#else
+        amrex::ignore_unused(a_vals, a_n, a_comm);
+#endif
+    }
+
+    void wait ()
+    {
+#ifdef BL_USE_MPI
+        if (m_req != MPI_REQUEST_NULL) {
+            BL_PROFILE("MLCGSolver::ParallelAllReduce");
+            BL_MPI_REQUIRE( MPI_Wait(&m_req, MPI_STATUS_IGNORE) );
+        }
+#endif
+    }
+
+private:
+    MPI_Request m_req = MPI_REQUEST_NULL;
+};
+
+//! Appends the wall time of the enclosing scope to a vector.
+struct IterTimer
+{
+    explicit IterTimer (Vector<double>& a_times)
+        : m_times(a_times), m_start(amrex::second()) {}
+    ~IterTimer () { m_times.push_back(amrex::second() - m_start); }
+    IterTimer (const IterTimer&) = delete;
+    IterTimer& operator= (const IterTimer&) = delete;
+private:
+    Vector<double>& m_times;
+    double m_start;
+};
+
 }
 
 MLCGSolver::MLCGSolver (MLMG* a_mlmg, MLLinOp& _lp, Type _typ)
@@ -71,9 +114,17 @@ MLCGSolver::solve (MultiFab&       sol,
                    Real            eps_rel,
                    Real            eps_abs)
 {
-    if (solver_type == Type::BiCGStab) {
+    iter_time.clear();
+    switch (solver_type) {
+    case Type::BiCGStab:
         return solve_bicgstab(sol,rhs,eps_rel,eps_abs);
-    } else {
+    case Type::PipelinedBiCGStab:
+        return solve_pipelined_bicgstab(sol,rhs,eps_rel,eps_abs);
+    case Type::PipelinedCG:
+        return solve_pipelined_cg(sol,rhs,eps_rel,eps_abs);
+    case Type::SStepCG:
+        return solve_sstep_cg(sol,rhs,eps_rel,eps_abs);
+    default:
         return solve_cg(sol,rhs,eps_rel,eps_abs);
     }
 }
@@ -142,6 +193,7 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
 
     for (; iter <= maxiter; ++iter)
     {
+        IterTimer itimer(iter_time);
         const Real rho = dotxy(rh,r);
         if ( rho == 0 )
         {
@@ -314,6 +366,7 @@ MLCGSolver::solve_cg (MultiFab&       sol,
 
     for (; iter <= maxiter; ++iter)
     {
+        IterTimer itimer(iter_time);
         MultiFab::Copy(z,r,0,0,ncomp,nghost);
 
         Real rho = dotxy(z,r);
@@ -396,6 +449,644 @@ MLCGSolver::solve_cg (MultiFab&       sol,
     return ret;
 }
 
+int
+MLCGSolver::solve_pipelined_bicgstab (MultiFab&       sol,
+                                      const MultiFab& rhs,
+                                      Real            eps_rel,
+                                      Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipelined_bicgstab");
+
+    // Pipelined BiCGStab of Cools & Vanroose (2017).  Each half iteration
+    // has a single reduction that is overlapped with an operator apply.
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // These are the vectors the operator is applied to.
+    MultiFab r(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    MultiFab w(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    MultiFab z(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    r.setVal(0.0);
+    w.setVal(0.0);
+    z.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab rh   (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab t    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab v    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab y    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+    Lp.normalize(amrlev, mglev, r);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+    MultiFab::Copy(rh,   r,  0,0,ncomp,nghost);
+
+    sol.setVal(0);
+
+    Lp.apply(amrlev, mglev, w, r, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+    Lp.normalize(amrlev, mglev, w);
+
+    Real dots[5] = { dotxy(r,r,true), dotxy(rh,w,true) };
+    {
+        NonBlockingSum reduction(dots, 2, Lp.BottomCommunicator());
+        Lp.apply(amrlev, mglev, t, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, t);
+        reduction.wait();
+    }
+
+    // rh == r initially, so (rh,r) is the square of the 2-norm of r.
+    Real rho = dots[0];
+    Real rnorm = std::sqrt(rho);
+    const Real rnorm0 = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipelinedBiCGStab: Initial error (error0) =        " << rnorm0 << '\n';
+    }
+    int ret = 0;
+    iter = 1;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 )
+        {
+            amrex::Print() << "MLCGSolver_PipelinedBiCGStab: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        sol.plus(sorig, 0, ncomp, nghost);
+        return ret;
+    }
+
+    if ( dots[1] == 0 )
+    {
+        ret = 2;
+        iter = 0;
+    }
+
+    Real alpha = (ret == 0) ? rho/dots[1] : Real(0.0);
+    Real beta = 0, omega = 0;
+
+    for (; ret == 0 && iter <= maxiter; ++iter)
+    {
+        IterTimer itimer(iter_time);
+
+        if ( iter == 1 )
+        {
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(z,t,0,0,ncomp,nghost);
+        }
+        else
+        {
+            sxay(p, p, -omega, s, nghost);
+            sxay(p, r,   beta, p, nghost);
+            sxay(s, s, -omega, z, nghost);
+            sxay(s, w,   beta, s, nghost);
+            sxay(z, z, -omega, v, nghost);
+            sxay(z, t,   beta, z, nghost);
+        }
+        sxay(q, r, -alpha, s, nghost);
+        sxay(y, w, -alpha, z, nghost);
+
+        dots[0] = dotxy(q,y,true);
+        dots[1] = dotxy(y,y,true);
+        dots[2] = dotxy(q,q,true);
+        {
+            NonBlockingSum reduction(dots, 3, Lp.BottomCommunicator());
+            Lp.apply(amrlev, mglev, v, z, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+            Lp.normalize(amrlev, mglev, v);
+            reduction.wait();
+        }
+
+        rnorm = std::sqrt(dots[2]);
+
+        if ( verbose > 2 && ParallelDescriptor::IOProcessor() )
+        {
+            amrex::Print() << "MLCGSolver_PipelinedBiCGStab: Half Iter "
+                           << std::setw(11) << iter
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs )
+        {
+            sxay(sol, sol, alpha, p, nghost);
+            MultiFab::Copy(r,q,0,0,ncomp,nghost);
+            break;
+        }
+
+        if ( dots[1] != Real(0.0) )
+        {
+            omega = dots[0]/dots[1];
+        }
+        else
+        {
+            ret = 3; break;
+        }
+
+        sxay(sol, sol, alpha, p, nghost);
+        sxay(sol, sol, omega, q, nghost);
+        sxay(r,     q, -omega, y, nghost);
+        sxay(t,     t, -alpha, v, nghost);
+        sxay(w,     y, -omega, t, nghost);
+
+        dots[0] = dotxy(rh,r,true);
+        dots[1] = dotxy(rh,w,true);
+        dots[2] = dotxy(rh,s,true);
+        dots[3] = dotxy(rh,z,true);
+        dots[4] = dotxy(r,r,true);
+        {
+            NonBlockingSum reduction(dots, 5, Lp.BottomCommunicator());
+            Lp.apply(amrlev, mglev, t, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+            Lp.normalize(amrlev, mglev, t);
+            reduction.wait();
+        }
+
+        rnorm = std::sqrt(dots[4]);
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipelinedBiCGStab: Iteration "
+                           << std::setw(11) << iter
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+
+        if ( omega == 0 )
+        {
+            ret = 4; break;
+        }
+
+        const Real rho_1 = rho;
+        rho = dots[0];
+        if ( rho == 0 )
+        {
+            ret = 1; break;
+        }
+        beta = (alpha/omega)*(rho/rho_1);
+        const Real denom = dots[1] + beta*dots[2] - beta*omega*dots[3];
+        if ( denom != Real(0.0) )
+        {
+            alpha = rho/denom;
+        }
+        else
+        {
+            ret = 2; break;
+        }
+    }
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipelinedBiCGStab: Final: Iteration "
+                       << std::setw(4) << iter
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 && rnorm > eps_rel*rnorm0 && rnorm > eps_abs)
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_PipelinedBiCGStab:: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
+int
+MLCGSolver::solve_pipelined_cg (MultiFab&       sol,
+                                const MultiFab& rhs,
+                                Real            eps_rel,
+                                Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipelined_cg");
+
+    // Pipelined CG of Ghysels & Vanroose (2014).  The two inner products of
+    // an iteration are reduced together while the operator is applied.
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // These are the vectors the operator is applied to.
+    MultiFab r(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    MultiFab w(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+    r.setVal(0.0);
+    w.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab z    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+
+    sol.setVal(0);
+
+    Lp.apply(amrlev, mglev, w, r, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+
+    Real gamma_1 = 0, alpha_1 = 0;
+    Real rnorm = -1, rnorm0 = -1;
+    int  ret = 0;
+    iter = 1;
+
+    for (; iter <= maxiter+1; ++iter)
+    {
+        IterTimer itimer(iter_time);
+
+        Real dots[2] = { dotxy(r,r,true), dotxy(w,r,true) };
+        NonBlockingSum reduction(dots, 2, Lp.BottomCommunicator());
+        if (iter <= maxiter) {
+            Lp.apply(amrlev, mglev, q, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        }
+        reduction.wait();
+
+        const Real gamma = dots[0];
+        const Real delta = dots[1];
+        rnorm = std::sqrt(gamma);
+
+        if (iter == 1)
+        {
+            rnorm0 = rnorm;
+            if ( verbose > 0 )
+            {
+                amrex::Print() << "MLCGSolver_PipelinedCG: Initial error (error0) :        " << rnorm0 << '\n';
+            }
+            if ( rnorm0 == 0 || rnorm0 < eps_abs )
+            {
+                if ( verbose > 0 ) {
+                    amrex::Print() << "MLCGSolver_PipelinedCG: niter = 0,"
+                                   << ", rnorm = " << rnorm
+                                   << ", eps_abs = " << eps_abs << std::endl;
+                }
+                sol.plus(sorig, 0, ncomp, nghost);
+                return ret;
+            }
+        }
+        else
+        {
+            // The reduction carries the residual of the previous update.
+            if ( verbose > 2 )
+            {
+                amrex::Print() << "MLCGSolver_PipelinedCG: Iteration"
+                               << std::setw(4) << iter-1
+                               << " rel. err. "
+                               << rnorm/(rnorm0) << '\n';
+            }
+            if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs || iter > maxiter )
+            {
+                --iter;
+                break;
+            }
+        }
+
+        Real alpha, beta;
+        if (iter == 1)
+        {
+            beta = 0;
+            alpha = (delta != Real(0.0)) ? gamma/delta : Real(0.0);
+        }
+        else
+        {
+            beta = gamma/gamma_1;
+            const Real denom = delta - beta*gamma/alpha_1;
+            alpha = (denom != Real(0.0)) ? gamma/denom : Real(0.0);
+        }
+        if ( alpha == Real(0.0) )
+        {
+            ret = 1; break;
+        }
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipelinedCG:"
+                           << " iter " << iter
+                           << " gamma " << gamma
+                           << " alpha " << alpha << '\n';
+        }
+
+        if (iter == 1)
+        {
+            MultiFab::Copy(z,q,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+        }
+        else
+        {
+            sxay(z, q, beta, z, nghost);
+            sxay(s, w, beta, s, nghost);
+            sxay(p, r, beta, p, nghost);
+        }
+        sxay(sol, sol, alpha, p, nghost);
+        sxay(  r,   r,-alpha, s, nghost);
+        sxay(  w,   w,-alpha, z, nghost);
+
+        gamma_1 = gamma;
+        alpha_1 = alpha;
+    }
+
+    // The last pass only finished the reduction for the convergence check.
+    if (static_cast<int>(iter_time.size()) > iter) {
+        iter_time.resize(iter);
+    }
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipelinedCG: Final Iteration"
+                       << std::setw(4) << iter
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 &&  rnorm > eps_rel*rnorm0 && rnorm > eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_PipelinedCG: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
+int
+MLCGSolver::solve_sstep_cg (MultiFab&       sol,
+                            const MultiFab& rhs,
+                            Real            eps_rel,
+                            Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::sstep_cg");
+
+    // s-step CG with a monomial basis (Chronopoulos & Gear 1989; Carson
+    // 2015).  For a block of s iterations we build the basis
+    //     V = [p, Ap, ..., A^s p, r, Ar, ..., A^(s-1) r]
+    // and its Gram matrix G = V^T V with a single reduction.  The s CG
+    // iterations are then done on the coordinates of x, r and p in V.
+
+    AMREX_ALWAYS_ASSERT(sstep >= 1);
+    const int ns = sstep;
+    const int nb = 2*ns+1;
+    const int ip = 0;      // index of p in V
+    const int ir = ns+1;   // index of r in V
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    Vector<MultiFab> V(nb);
+    for (auto& mf : V) {
+        mf.define(ba, dm, ncomp, sol.nGrowVect(), MFInfo(), factory);
+        mf.setVal(0.0);
+    }
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab pnew (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab rnew (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+
+    MultiFab& r = V[ir];
+    MultiFab& p = V[ip];
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+
+    sol.setVal(0);
+
+    Real       rnorm    = std::sqrt(dotxy(r,r));
+    const Real rnorm0   = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_SStepCG: Initial error (error0) :        " << rnorm0 << '\n';
+    }
+
+    int  ret = 0;
+    iter = 0;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 ) {
+            amrex::Print() << "MLCGSolver_SStepCG: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        sol.plus(sorig, 0, ncomp, nghost);
+        return ret;
+    }
+
+    MultiFab::Copy(p,r,0,0,ncomp,nghost);
+
+    Vector<Real> G(nb*nb);
+    Vector<Real> gram((nb*(nb+1))/2);
+    Vector<Real> xc(nb), rc(nb), pc(nb), apc(nb), rc_new(nb);
+
+    // a^T G b
+    auto gdot = [&] (Vector<Real> const& a, Vector<Real> const& b) -> Real
+    {
+        Real result = 0;
+        for (int i = 0; i < nb; ++i) {
+            if (a[i] == Real(0.0)) continue;
+            for (int j = 0; j < nb; ++j) {
+                result += a[i]*G[i*nb+j]*b[j];
+            }
+        }
+        return result;
+    };
+
+    // Coordinates of A*v for v in the span of the basis vectors that are
+    // not the last of their Krylov sequence.
+    auto shift = [&] (Vector<Real> const& a, Vector<Real>& b)
+    {
+        std::fill(b.begin(), b.end(), Real(0.0));
+        for (int i = 0; i < ns; ++i) {
+            b[ip+i+1] = a[ip+i];
+        }
+        for (int i = 0; i < ns-1; ++i) {
+            b[ir+i+1] = a[ir+i];
+        }
+    };
+
+    // Linear combination of the basis vectors.
+    auto combine = [&] (MultiFab& dst, Vector<Real> const& a)
+    {
+        dst.setVal(0.0);
+        for (int i = 0; i < nb; ++i) {
+            if (a[i] != Real(0.0)) {
+                MultiFab::Saxpy(dst, a[i], V[i], 0, 0, ncomp, nghost);
+            }
+        }
+    };
+
+    bool converged = false;
+    while (!converged && ret == 0 && iter < maxiter)
+    {
+        const double block_start = amrex::second();
+
+        for (int i = 0; i < ns; ++i) {
+            Lp.apply(amrlev, mglev, V[ip+i+1], V[ip+i], MLLinOp::BCMode::Homogeneous,
+                     MLLinOp::StateMode::Correction);
+        }
+        for (int i = 0; i < ns-1; ++i) {
+            Lp.apply(amrlev, mglev, V[ir+i+1], V[ir+i], MLLinOp::BCMode::Homogeneous,
+                     MLLinOp::StateMode::Correction);
+        }
+
+        for (int i = 0, n = 0; i < nb; ++i) {
+            for (int j = i; j < nb; ++j, ++n) {
+                gram[n] = dotxy(V[i],V[j],true);
+            }
+        }
+        {
+            BL_PROFILE("MLCGSolver::ParallelAllReduce");
+            ParallelAllReduce::Sum(gram.data(), static_cast<int>(gram.size()), Lp.BottomCommunicator());
+        }
+        for (int i = 0, n = 0; i < nb; ++i) {
+            for (int j = i; j < nb; ++j, ++n) {
+                G[i*nb+j] = G[j*nb+i] = gram[n];
+            }
+        }
+
+        std::fill(xc.begin(), xc.end(), Real(0.0));
+        std::fill(rc.begin(), rc.end(), Real(0.0));
+        std::fill(pc.begin(), pc.end(), Real(0.0));
+        rc[ir] = 1;
+        pc[ip] = 1;
+        Real rr = gdot(rc,rc);
+
+        int nin = 0;
+        for (; nin < ns && iter < maxiter; ++nin)
+        {
+            shift(pc, apc);
+            const Real pap = gdot(pc, apc);
+            // The operator may be negative definite (e.g., MLPoisson).
+            if ( pap == Real(0.0) || rr <= Real(0.0) )
+            {
+                ret = 1; break;
+            }
+            const Real alpha = rr/pap;
+            for (int i = 0; i < nb; ++i) {
+                xc[i] += alpha*pc[i];
+                rc_new[i] = rc[i] - alpha*apc[i];
+            }
+            const Real rr_new = gdot(rc_new, rc_new);
+            ++iter;
+
+            rnorm = std::sqrt(amrex::max(rr_new, Real(0.0)));
+
+            if ( verbose > 2 )
+            {
+                amrex::Print() << "MLCGSolver_SStepCG: Iteration"
+                               << std::setw(4) << iter
+                               << " rel. err. "
+                               << rnorm/(rnorm0) << '\n';
+            }
+
+            const Real beta = rr_new/rr;
+            for (int i = 0; i < nb; ++i) {
+                pc[i] = rc_new[i] + beta*pc[i];
+            }
+            std::swap(rc, rc_new);
+            rr = rr_new;
+
+            if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs )
+            {
+                converged = true;
+                ++nin;
+                break;
+            }
+        }
+
+        if (ret == 0)
+        {
+            for (int i = 0; i < nb; ++i) {
+                if (xc[i] != Real(0.0)) {
+                    MultiFab::Saxpy(sol, xc[i], V[i], 0, 0, ncomp, nghost);
+                }
+            }
+            combine(rnew, rc);
+            combine(pnew, pc);
+            MultiFab::Copy(r,rnew,0,0,ncomp,nghost);
+            MultiFab::Copy(p,pnew,0,0,ncomp,nghost);
+        }
+
+        const double block_time = amrex::second() - block_start;
+        for (int i = 0; i < nin; ++i) {
+            iter_time.push_back(block_time/nin);
+        }
+    }
+
+    if (ret == 0)
+    {
+        // The residual norm from the Gram matrix can lose accuracy, so the
+        // final check uses the residual vector itself.
+        rnorm = std::sqrt(dotxy(r,r));
+    }
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_SStepCG: Final Iteration"
+                       << std::setw(4) << iter
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 &&  rnorm > eps_rel*rnorm0 && rnorm > eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_SStepCG: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
 Real
 MLCGSolver::dotxy (const MultiFab& r, const MultiFab& z, bool local)
 {
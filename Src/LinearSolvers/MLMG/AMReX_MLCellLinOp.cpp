@@ -568,6 +568,219 @@ MLCellLinOp::correctionResidual (int amrlev, int mglev, MultiFab& resid, MultiFa
     MultiFab::Xpay(resid, Real(-1.0), b, 0, 0, ncomp, 0);
 }
 
+void
+MLCellLinOp::smoothSingle (int amrlev, int mglev, fMultiFab& sol, const fMultiFab& rhs,
+                           bool skip_fillboundary) const
+{
+    BL_PROFILE("MLCellLinOp::smoothSingle()");
+    for (int redblack = 0; redblack < 2; ++redblack)
+    {
+        applyBCSingle(amrlev, mglev, sol, skip_fillboundary);
+        FsmoothSingle(amrlev, mglev, sol, rhs, redblack);
+        skip_fillboundary = false;
+    }
+}
+
+void
+MLCellLinOp::correctionResidualSingle (int amrlev, int mglev, fMultiFab& resid, fMultiFab& x,
+                                       const fMultiFab& b) const
+{
+    BL_PROFILE("MLCellLinOp::correctionResidualSingle()");
+    const int ncomp = getNComp();
+    applyBCSingle(amrlev, mglev, x);
+    FapplySingle(amrlev, mglev, resid, x);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(resid,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<float> const& rfab = resid.array(mfi);
+        Array4<float const> const& bfab = b.const_array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            rfab(i,j,k,n) = bfab(i,j,k,n) - rfab(i,j,k,n);
+        });
+    }
+}
+
+void
+MLCellLinOp::restrictionSingle (int amrlev, int cmglev, fMultiFab& crse, fMultiFab& fine) const
+{
+    BL_PROFILE("MLCellLinOp::restrictionSingle()");
+
+    const int ncomp = getNComp();
+
+    Dim3 ratio3 = {1,1,1};
+    IntVect ratio = (amrlev > 0) ? IntVect(2) : mg_coarsen_ratio_vec[cmglev-1];
+    AMREX_D_TERM(ratio3.x = ratio[0];,
+                 ratio3.y = ratio[1];,
+                 ratio3.z = ratio[2];);
+    const Real volinv = Real(1.0) / Real(ratio3.x*ratio3.y*ratio3.z);
+
+    // With agglomeration, crse is not simply the coarsened fine BoxArray.
+    BoxArray cba = amrex::coarsen(fine.boxArray(), ratio);
+    const bool direct = cba == crse.boxArray()
+        && fine.DistributionMap() == crse.DistributionMap();
+    fMultiFab ctmp;
+    if (!direct) {
+        ctmp.define(cba, fine.DistributionMap(), ncomp, 0);
+    }
+    fMultiFab& cdst = direct ? crse : ctmp;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(cdst,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<float> const& cfab = cdst.array(mfi);
+        Array4<float const> const& ffab = fine.const_array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            Real c = Real(0.0);
+            for (int kk = 0; kk < ratio3.z; ++kk) {
+            for (int jj = 0; jj < ratio3.y; ++jj) {
+            for (int ii = 0; ii < ratio3.x; ++ii) {
+                c += ffab(i*ratio3.x+ii, j*ratio3.y+jj, k*ratio3.z+kk, n);
+            }}}
+            cfab(i,j,k,n) = static_cast<float>(c*volinv);
+        });
+    }
+
+    if (!direct) {
+        crse.ParallelCopy(ctmp, 0, 0, ncomp);
+    }
+}
+
+void
+MLCellLinOp::interpolationSingle (int amrlev, int fmglev, fMultiFab& fine, const fMultiFab& crse) const
+{
+    BL_PROFILE("MLCellLinOp::interpolationSingle()");
+
+    const int ncomp = getNComp();
+
+    Dim3 ratio3 = {2,2,2};
+    IntVect ratio = (amrlev > 0) ? IntVect(2) : mg_coarsen_ratio_vec[fmglev];
+    AMREX_D_TERM(ratio3.x = ratio[0];,
+                 ratio3.y = ratio[1];,
+                 ratio3.z = ratio[2];);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(fine,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        Array4<float const> const& cfab = crse.const_array(mfi);
+        Array4<float> const& ffab = fine.array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+        {
+            int ic = amrex::coarsen(i,ratio3.x);
+            int jc = amrex::coarsen(j,ratio3.y);
+            int kc = amrex::coarsen(k,ratio3.z);
+            ffab(i,j,k,n) += cfab(ic,jc,kc,n);
+        });
+    }
+}
+
+void
+MLCellLinOp::applyBCSingle (int amrlev, int mglev, fMultiFab& in, bool skip_fillboundary) const
+{
+    BL_PROFILE("MLCellLinOp::applyBCSingle()");
+    AMREX_ALWAYS_ASSERT(isCrossStencil() && !isTensorOp());
+
+    const int ncomp = getNComp();
+    if (!skip_fillboundary) {
+        const int cross = true;
+        in.FillBoundary(0, ncomp, m_geom[amrlev][mglev].periodicity(), cross);
+    }
+
+    const int imaxorder = maxorder;
+    const int flagbc = 0;
+
+    const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
+    const Real dxi = dxinv[0];
+    const Real dyi = (AMREX_SPACEDIM >= 2) ? dxinv[1] : Real(1.0);
+    const Real dzi = (AMREX_SPACEDIM == 3) ? dxinv[2] : Real(1.0);
+
+    const auto& maskvals = m_maskvals[amrlev][mglev];
+    const auto& bcondloc = *m_bcondloc[amrlev][mglev];
+
+    // Boundary values are not used with homogeneous BC.
+    const Array4<float const> foo{};
+
+    const int hidden_direction = hiddenDirection();
+
+    MFItInfo mfi_info;
+    if (Gpu::notInLaunchRegion()) mfi_info.SetDynamic(true);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(in, mfi_info); mfi.isValid(); ++mfi)
+    {
+        const Box& vbx   = mfi.validbox();
+        const auto& iofab = in.array(mfi);
+
+        const auto & bdlv = bcondloc.bndryLocs(mfi);
+        const auto & bdcv = bcondloc.bndryConds(mfi);
+
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+        {
+            if (hidden_direction == idim) continue;
+            const Orientation olo(idim,Orientation::low);
+            const Orientation ohi(idim,Orientation::high);
+            const Box blo = amrex::adjCellLo(vbx, idim);
+            const Box bhi = amrex::adjCellHi(vbx, idim);
+            const int blen = vbx.length(idim);
+            Array4<int const> const& mlo = maskvals[olo].const_array(mfi);
+            Array4<int const> const& mhi = maskvals[ohi].const_array(mfi);
+            for (int icomp = 0; icomp < ncomp; ++icomp) {
+                const BoundCond bctlo = bdcv[icomp][olo];
+                const BoundCond bcthi = bdcv[icomp][ohi];
+                const Real bcllo = bdlv[icomp][olo];
+                const Real bclhi = bdlv[icomp][ohi];
+                if (idim == 0) {
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(blo, i, j, k,
+                    {
+                        mllinop_apply_bc_x(0, i, j, k, blen, iofab, mlo, bctlo, bcllo, foo,
+                                           imaxorder, dxi, flagbc, icomp);
+                    });
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bhi, i, j, k,
+                    {
+                        mllinop_apply_bc_x(1, i, j, k, blen, iofab, mhi, bcthi, bclhi, foo,
+                                           imaxorder, dxi, flagbc, icomp);
+                    });
+                } else if (idim == 1) {
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(blo, i, j, k,
+                    {
+                        mllinop_apply_bc_y(0, i, j, k, blen, iofab, mlo, bctlo, bcllo, foo,
+                                           imaxorder, dyi, flagbc, icomp);
+                    });
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bhi, i, j, k,
+                    {
+                        mllinop_apply_bc_y(1, i, j, k, blen, iofab, mhi, bcthi, bclhi, foo,
+                                           imaxorder, dyi, flagbc, icomp);
+                    });
+                } else {
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(blo, i, j, k,
+                    {
+                        mllinop_apply_bc_z(0, i, j, k, blen, iofab, mlo, bctlo, bcllo, foo,
+                                           imaxorder, dzi, flagbc, icomp);
+                    });
+                    AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bhi, i, j, k,
+                    {
+                        mllinop_apply_bc_z(1, i, j, k, blen, iofab, mhi, bcthi, bclhi, foo,
+                                           imaxorder, dzi, flagbc, icomp);
+                    });
+                }
+            }
+        }
+    }
+}
+
 void
 MLCellLinOp::applyBC (int amrlev, int mglev, MultiFab& in, BCMode bc_mode, StateMode,
                       const MLMGBndry* bndry, bool skip_fillboundary) const
@@ -39,6 +39,28 @@
 
 namespace amrex {
 
+namespace {
+    // Copy between single and double precision data
+    template <class DFAB, class SFAB>
+    void mlmg_convert (FabArray<DFAB>& dst, FabArray<SFAB> const& src, int ncomp)
+    {
+        using T = typename DFAB::value_type;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(dst,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            auto const& d = dst.array(mfi);
+            auto const& s = src.const_array(mfi);
+            AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
+            {
+                d(i,j,k,n) = static_cast<T>(s(i,j,k,n));
+            });
+        }
+    }
+}
+
 MLMG::MLMG (MLLinOp& a_lp)
     : linop(a_lp),
       namrlevs(a_lp.NAMRLevels()),
@@ -78,6 +100,7 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     Real& composite_norminf = m_final_resnorm0;
 
     m_niters_cg.clear();
+    m_cg_iter_time.clear();
     m_iter_fine_resnorm0.clear();
 
     prepareForSolve(a_sol, a_rhs);
@@ -223,6 +246,57 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     return composite_norminf;
 }
 
+Real
+MLMG::solveBatch (const Vector<Vector<MultiFab*> >& a_sol,
+                  const Vector<Vector<MultiFab const*> >& a_rhs,
+                  Real a_tol_rel, Real a_tol_abs)
+{
+    BL_PROFILE("MLMG::solveBatch()");
+
+    const int nbatch = static_cast<int>(a_sol.size());
+    AMREX_ALWAYS_ASSERT(nbatch > 0 && a_rhs.size() == a_sol.size());
+
+    const int ncomp = linop.getNComp();
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ncomp % nbatch == 0,
+                                     "MLMG::solveBatch: linop.getNComp() is not a multiple of the batch size");
+    const int nc = ncomp / nbatch;
+
+    const int nlevs = static_cast<int>(a_sol[0].size());
+    Vector<MultiFab> bsol(nlevs);
+    Vector<MultiFab> brhs(nlevs);
+    for (int alev = 0; alev < nlevs; ++alev)
+    {
+        const MultiFab& sol0 = *a_sol[0][alev];
+        const MultiFab& rhs0 = *a_rhs[0][alev];
+        bsol[alev].define(sol0.boxArray(), sol0.DistributionMap(), ncomp, sol0.nGrowVect(),
+                          MFInfo(), sol0.Factory());
+        brhs[alev].define(rhs0.boxArray(), rhs0.DistributionMap(), ncomp, 0,
+                          MFInfo(), rhs0.Factory());
+        for (int n = 0; n < nbatch; ++n)
+        {
+            AMREX_ALWAYS_ASSERT(a_sol[n].size() == a_sol[0].size() &&
+                                a_rhs[n].size() == a_sol[0].size() &&
+                                a_sol[n][alev]->nComp() == nc &&
+                                a_rhs[n][alev]->nComp() == nc &&
+                                a_sol[n][alev]->nGrowVect() == sol0.nGrowVect());
+            MultiFab::Copy(bsol[alev], *a_sol[n][alev], 0, n*nc, nc, sol0.nGrowVect());
+            MultiFab::Copy(brhs[alev], *a_rhs[n][alev], 0, n*nc, nc, 0);
+        }
+    }
+
+    Real r = solve(GetVecOfPtrs(bsol), GetVecOfConstPtrs(brhs), a_tol_rel, a_tol_abs);
+
+    for (int alev = 0; alev < nlevs; ++alev)
+    {
+        for (int n = 0; n < nbatch; ++n)
+        {
+            MultiFab::Copy(*a_sol[n][alev], bsol[alev], n*nc, 0, nc, bsol[alev].nGrowVect());
+        }
+    }
+
+    return r;
+}
+
 // in  : Residual (res) on the finest AMR level
 // out : sol on all AMR levels
 void MLMG::oneIter (int iter)
@@ -257,7 +331,9 @@ void MLMG::oneIter (int iter)
             makeSolvable(0,0,res[0][0]);
         }
 
-        if (iter < max_fmg_iters) {
+        if (use_mixed_precision) {
+            mgVcycleSingle();
+        } else if (iter < max_fmg_iters) {
             mgFcycle ();
         } else {
             mgVcycle (0, 0);
@@ -513,6 +589,90 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
     }
 }
 
+// V-cycle in single precision on the only AMR level.
+// in   : Residual (res) on the top MG level
+// out  : Correction (cor) on the top MG level
+void
+MLMG::mgVcycleSingle ()
+{
+    BL_PROFILE("MLMG::mgVcycleSingle()");
+
+    const int amrlev = 0;
+    const int mglev_bottom = linop.NMGLevels(amrlev) - 1;
+    const int ncomp = linop.getNComp();
+
+    mlmg_convert(fres[0], res[amrlev][0], ncomp);
+
+    for (int mglev = 0; mglev < mglev_bottom; ++mglev)
+    {
+        fcor[mglev].setVal(0.0f);
+        bool skip_fillboundary = true;
+        for (int i = 0; i < nu1; ++i) {
+            linop.smoothSingle(amrlev, mglev, fcor[mglev], fres[mglev], skip_fillboundary);
+            skip_fillboundary = false;
+        }
+
+        // rescor = res - L(cor)
+        linop.correctionResidualSingle(amrlev, mglev, frescor[mglev], fcor[mglev], fres[mglev]);
+
+        // res_crse = R(rescor_fine)
+        linop.restrictionSingle(amrlev, mglev+1, fres[mglev+1], frescor[mglev]);
+    }
+
+    BL_PROFILE_VAR("MLMG::mgVcycleSingle_bottom", blp_bottom);
+    if (bottom_solver == BottomSolver::smoother && !do_nsolve)
+    {
+        auto bottom_start_time = amrex::second();
+        fcor[mglev_bottom].setVal(0.0f);
+        if (linop.isBottomActive())
+        {
+            ParallelContext::push(linop.BottomCommunicator());
+            bool skip_fillboundary = true;
+            for (int i = 0; i < nuf; ++i) {
+                linop.smoothSingle(amrlev, mglev_bottom, fcor[mglev_bottom], fres[mglev_bottom],
+                                   skip_fillboundary);
+                skip_fillboundary = false;
+            }
+            ParallelContext::pop();
+        }
+        timer[bottom_time] += amrex::second() - bottom_start_time;
+    }
+    else
+    {
+        // The bottom level is small.  Krylov, hypre, PETSc and N-Solve
+        // bottom solvers work in double precision.
+        mlmg_convert(res[amrlev][mglev_bottom], fres[mglev_bottom], ncomp);
+        bottomSolve();
+        mlmg_convert(fcor[mglev_bottom], *cor[amrlev][mglev_bottom], ncomp);
+    }
+    BL_PROFILE_VAR_STOP(blp_bottom);
+
+    for (int mglev = mglev_bottom-1; mglev >= 0; --mglev)
+    {
+        // cor_fine += I(cor_crse)
+        const auto& crse_cor = fcor[mglev+1];
+        auto& fine_cor = fcor[mglev];
+        if (amrex::isMFIterSafe(crse_cor, fine_cor))
+        {
+            linop.interpolationSingle(amrlev, mglev, fine_cor, crse_cor);
+        }
+        else
+        {
+            BoxArray cba = fine_cor.boxArray();
+            cba.coarsen(linop.mg_coarsen_ratio_vec[mglev]);
+            MLLinOp::fMultiFab cfine(cba, fine_cor.DistributionMap(), ncomp, 0);
+            cfine.ParallelCopy(crse_cor);
+            linop.interpolationSingle(amrlev, mglev, fine_cor, cfine);
+        }
+
+        for (int i = 0; i < nu2; ++i) {
+            linop.smoothSingle(amrlev, mglev, fcor[mglev], fres[mglev]);
+        }
+    }
+
+    mlmg_convert(*cor[amrlev][0], fcor[0], ncomp);
+}
+
 // FMG cycle on the coarsest AMR level.
 // in:  Residual on the top MG level (i.e., 0)
 // out: Correction (cor) on all MG levels
@@ -967,6 +1127,12 @@ MLMG::actualBottomSolve ()
             if (bottom_solver == BottomSolver::cg ||
                 bottom_solver == BottomSolver::cgbicg) {
                 cg_type = MLCGSolver::Type::CG;
+            } else if (bottom_solver == BottomSolver::pipecg) {
+                cg_type = MLCGSolver::Type::PipelinedCG;
+            } else if (bottom_solver == BottomSolver::pipebicgstab) {
+                cg_type = MLCGSolver::Type::PipelinedBiCGStab;
+            } else if (bottom_solver == BottomSolver::sstepcg) {
+                cg_type = MLCGSolver::Type::SStepCG;
             } else {
                 cg_type = MLCGSolver::Type::BiCGStab;
             }
@@ -1012,6 +1178,7 @@ MLMG::bottomSolveWithCG (MultiFab& x, const MultiFab& b, MLCGSolver::Type type)
     cg_solver.setSolver(type);
     cg_solver.setVerbose(bottom_verbose);
     cg_solver.setMaxIter(bottom_maxiter);
+    cg_solver.setSStep(bottom_sstep);
     if (cf_strategy == CFStrategy::ghostnodes) cg_solver.setNGhost(linop.getNGrow());
 
     int ret = cg_solver.solve(x, b, bottom_reltol, bottom_abstol);
@@ -1019,6 +1186,18 @@ MLMG::bottomSolveWithCG (MultiFab& x, const MultiFab& b, MLCGSolver::Type type)
         amrex::Print() << "MLMG: Bottom solve failed.\n";
     }
     m_niters_cg.push_back(cg_solver.getNumIters());
+
+    auto const& iter_time = cg_solver.getIterTimes();
+    Real avg_time = 0.0;
+    if (!iter_time.empty()) {
+        for (auto t : iter_time) { avg_time += t; }
+        avg_time /= iter_time.size();
+    }
+    m_cg_iter_time.push_back(avg_time);
+    if (bottom_verbose > 0) {
+        amrex::Print() << "MLMG: Bottom solve " << iter_time.size()
+                       << " iterations, average time per iteration = " << avg_time << "\n";
+    }
     return ret;
 }
 
@@ -1332,6 +1511,28 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
         prepareForNSolve();
     }
 
+    use_mixed_precision = do_mixed_precision && namrlevs == 1
+        && cf_strategy == CFStrategy::none && linop.supportsMixedPrecision();
+    if (do_mixed_precision && !use_mixed_precision && verbose >= 1) {
+        amrex::Print() << "MLMG: Mixed precision is not supported for this solve."
+                       << " The V-cycle will be in double precision.\n";
+    }
+    if (use_mixed_precision && fres.empty())
+    {
+        const int nmglevs = linop.NMGLevels(0);
+        fres.resize(nmglevs);
+        fcor.resize(nmglevs);
+        frescor.resize(nmglevs);
+        for (int mglev = 0; mglev < nmglevs; ++mglev)
+        {
+            const BoxArray& ba = res[0][mglev].boxArray();
+            const DistributionMapping& dm = res[0][mglev].DistributionMap();
+            fres[mglev].define(ba, dm, ncomp, res[0][mglev].nGrowVect());
+            frescor[mglev].define(ba, dm, ncomp, rescor[0][mglev].nGrowVect());
+            fcor[mglev].define(ba, dm, ncomp, cor[0][mglev]->nGrowVect());
+        }
+    }
+
     if (verbose >= 2) {
         amrex::Print() << "MLMG: # of AMR levels: " << namrlevs << "\n"
                        << "      # of MG levels on the coarsest AMR level: " << linop.NMGLevels(0)
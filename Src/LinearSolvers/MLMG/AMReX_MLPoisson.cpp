@@ -461,6 +461,150 @@ MLPoisson::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs, i
     }
 }
 
+bool
+MLPoisson::supportsMixedPrecision () const
+{
+    if (m_has_metric_term || hasHiddenDimension()) return false;
+    for (auto const& osm_amrlev : m_overset_mask) {
+        for (auto const& osm : osm_amrlev) {
+            if (osm) return false;
+        }
+    }
+    return true;
+}
+
+void
+MLPoisson::FapplySingle (int amrlev, int mglev, fMultiFab& out, const fMultiFab& in) const
+{
+    BL_PROFILE("MLPoisson::FapplySingle()");
+
+    const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
+    AMREX_D_TERM(const Real dhx = dxinv[0]*dxinv[0];,
+                 const Real dhy = dxinv[1]*dxinv[1];,
+                 const Real dhz = dxinv[2]*dxinv[2];);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(out, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const auto& xfab = in.const_array(mfi);
+        const auto& yfab = out.array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bx, i, j, k,
+        {
+            amrex::ignore_unused(j,k);
+            mlpoisson_adotx(AMREX_D_DECL(i,j,k), yfab, xfab, AMREX_D_DECL(dhx,dhy,dhz));
+        });
+    }
+}
+
+void
+MLPoisson::FsmoothSingle (int amrlev, int mglev, fMultiFab& sol, const fMultiFab& rhs, int redblack) const
+{
+    BL_PROFILE("MLPoisson::FsmoothSingle()");
+
+    const auto& undrrelxr = m_undrrelxr[amrlev][mglev];
+    const auto& maskvals  = m_maskvals [amrlev][mglev];
+
+    OrientationIter oitr;
+
+    const FabSet& f0 = undrrelxr[oitr()]; ++oitr;
+    const FabSet& f1 = undrrelxr[oitr()]; ++oitr;
+#if (AMREX_SPACEDIM > 1)
+    const FabSet& f2 = undrrelxr[oitr()]; ++oitr;
+    const FabSet& f3 = undrrelxr[oitr()]; ++oitr;
+#if (AMREX_SPACEDIM > 2)
+    const FabSet& f4 = undrrelxr[oitr()]; ++oitr;
+    const FabSet& f5 = undrrelxr[oitr()]; ++oitr;
+#endif
+#endif
+
+    const MultiMask& mm0 = maskvals[0];
+    const MultiMask& mm1 = maskvals[1];
+#if (AMREX_SPACEDIM > 1)
+    const MultiMask& mm2 = maskvals[2];
+    const MultiMask& mm3 = maskvals[3];
+#if (AMREX_SPACEDIM > 2)
+    const MultiMask& mm4 = maskvals[4];
+    const MultiMask& mm5 = maskvals[5];
+#endif
+#endif
+
+    const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
+    AMREX_D_TERM(const Real dhx = dxinv[0]*dxinv[0];,
+                 const Real dhy = dxinv[1]*dxinv[1];,
+                 const Real dhz = dxinv[2]*dxinv[2];);
+
+    MFItInfo mfi_info;
+    if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling().SetDynamic(true);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(sol,mfi_info); mfi.isValid(); ++mfi)
+    {
+        const auto& m0 = mm0.array(mfi);
+        const auto& m1 = mm1.array(mfi);
+#if (AMREX_SPACEDIM > 1)
+        const auto& m2 = mm2.array(mfi);
+        const auto& m3 = mm3.array(mfi);
+#if (AMREX_SPACEDIM > 2)
+        const auto& m4 = mm4.array(mfi);
+        const auto& m5 = mm5.array(mfi);
+#endif
+#endif
+
+        const Box& tbx = mfi.tilebox();
+        const Box& vbx = mfi.validbox();
+        const auto& solnfab = sol.array(mfi);
+        const auto& rhsfab  = rhs.const_array(mfi);
+
+        const auto& f0fab = f0.array(mfi);
+        const auto& f1fab = f1.array(mfi);
+#if (AMREX_SPACEDIM > 1)
+        const auto& f2fab = f2.array(mfi);
+        const auto& f3fab = f3.array(mfi);
+#if (AMREX_SPACEDIM > 2)
+        const auto& f4fab = f4.array(mfi);
+        const auto& f5fab = f5.array(mfi);
+#endif
+#endif
+
+#if (AMREX_SPACEDIM == 1)
+        AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( tbx, thread_box,
+        {
+            mlpoisson_gsrb(thread_box, solnfab, rhsfab, dhx,
+                           f0fab, m0,
+                           f1fab, m1,
+                           vbx, redblack);
+        });
+#elif (AMREX_SPACEDIM == 2)
+        AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( tbx, thread_box,
+        {
+            mlpoisson_gsrb(thread_box, solnfab, rhsfab, dhx, dhy,
+                           f0fab, m0,
+                           f1fab, m1,
+                           f2fab, m2,
+                           f3fab, m3,
+                           vbx, redblack);
+        });
+#else
+        AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( tbx, thread_box,
+        {
+            mlpoisson_gsrb(thread_box, solnfab, rhsfab, dhx, dhy, dhz,
+                           f0fab, m0,
+                           f1fab, m1,
+                           f2fab, m2,
+                           f3fab, m3,
+                           f4fab, m4,
+                           f5fab, m5,
+                           vbx, redblack);
+        });
+#endif
+    }
+}
+
 void
 MLPoisson::FFlux (int amrlev, const MFIter& mfi,
                   const Array<FArrayBox*,AMREX_SPACEDIM>& flux,
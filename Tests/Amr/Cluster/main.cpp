@@ -0,0 +1,141 @@
+#include <AMReX.H>
+#include <AMReX_AmrMesh.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+// Tags a spherical shell and a small blob so that the clusters have holes
+// and are spread over several boxes and processes.
+class ClusterMesh
+    : public AmrMesh
+{
+public:
+    void ErrorEst (int lev, TagBoxArray& tags, Real /*time*/, int /*ngrow*/) override
+    {
+        const auto problo = Geom(lev).ProbLoArray();
+        const auto dx = Geom(lev).CellSizeArray();
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            auto const& tag = tags.array(mfi);
+            ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                RealVect x(AMREX_D_DECL(problo[0]+(i+0.5_rt)*dx[0],
+                                        problo[1]+(j+0.5_rt)*dx[1],
+                                        problo[2]+(k+0.5_rt)*dx[2]));
+                Real r1 = 0._rt, r2 = 0._rt;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    r1 += (x[idim]-0.45_rt)*(x[idim]-0.45_rt);
+                    r2 += (x[idim]-0.78_rt)*(x[idim]-0.78_rt);
+                }
+                r1 = std::sqrt(r1);
+                r2 = std::sqrt(r2);
+                if ((r1 > 0.22_rt && r1 < 0.25_rt) || r2 < 0.06_rt) {
+                    tag(i,j,k) = TagBox::SET;
+                }
+            });
+        }
+    }
+
+    // Number of tags after buffering and coarsening by the blocking
+    // factor, computed the same way as in MakeNewGrids.  Also checks
+    // that the tags are covered by the level 1 grids.
+    Long CheckTags (bool& covered)
+    {
+        const IntVect bf_lev = amrex::max(IntVect(1), blockingFactor(1)/refRatio(0));
+        TagBoxArray tags(boxArray(0), DistributionMap(0), nErrorBufVect(0));
+        ErrorEst(0, tags, 0._rt, 0);
+        tags.buffer(nErrorBufVect(0));
+        tags.coarsen(bf_lev);
+        const Box cdomain = amrex::coarsen(Geom(0).Domain(), bf_lev);
+        tags.mapPeriodicRemoveDuplicates(Geometry(cdomain, Geom(0).ProbDomain(),
+                                                  Geom(0).CoordInt(), Geom(0).isPeriodic()));
+        Gpu::PinnedVector<IntVect> tagvec;
+        tags.local_collate(tagvec);
+
+        const BoxArray cba = amrex::coarsen(boxArray(1), refRatio(0)*bf_lev);
+        covered = true;
+        Long ntags = 0;
+        for (auto const& iv : tagvec) {
+            if (cdomain.contains(iv)) {
+                ++ntags;
+                covered = covered && cba.contains(iv);
+            }
+        }
+        ParallelDescriptor::ReduceLongSum(ntags);
+        ParallelDescriptor::ReduceBoolAnd(covered);
+        return ntags;
+    }
+};
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        Vector<int> blocking_factor;
+        Vector<int> n_proper;
+        Vector<Real> grid_eff;
+        {
+            ParmParse pp;
+            pp.getarr("blocking_factor", blocking_factor);
+            pp.getarr("n_proper", n_proper);
+            pp.getarr("grid_eff", grid_eff);
+        }
+        AMREX_ALWAYS_ASSERT(blocking_factor.size() == n_proper.size() &&
+                            blocking_factor.size() == grid_eff.size());
+
+        ClusterMesh mesh;
+        AMREX_ALWAYS_ASSERT(mesh.maxLevel() == 1);
+
+        for (int icase = 0; icase < blocking_factor.size(); ++icase)
+        {
+            mesh.SetBlockingFactor(blocking_factor[icase]);
+            mesh.SetNProper(n_proper[icase]);
+            mesh.SetGridEff(grid_eff[icase]);
+
+            amrex::Print() << "blocking_factor = " << blocking_factor[icase]
+                           << ", n_proper = " << n_proper[icase]
+                           << ", grid_eff = " << grid_eff[icase] << "\n";
+
+            Array<Long,2> ncells;
+            for (int parallel = 0; parallel < 2; ++parallel)
+            {
+                mesh.SetUseParallelCluster(parallel);
+                mesh.MakeNewGrids(0.0);
+                AMREX_ALWAYS_ASSERT(mesh.finestLevel() == 1);
+
+                const BoxArray& fba = mesh.boxArray(1);
+                const BoxArray& cba = mesh.boxArray(0);
+                const IntVect bf = mesh.blockingFactor(1);
+                const Box& cdomain = mesh.Geom(0).Domain();
+                for (int i = 0; i < fba.size(); ++i) {
+                    // blocking factor
+                    AMREX_ALWAYS_ASSERT(fba[i].coarsenable(bf));
+                    // proper nesting
+                    Box cb = amrex::grow(amrex::coarsen(fba[i], mesh.refRatio(0)),
+                                         mesh.nProper()) & cdomain;
+                    AMREX_ALWAYS_ASSERT(cba.contains(cb));
+                }
+                AMREX_ALWAYS_ASSERT(fba.isDisjoint());
+
+                // grid efficiency in the index space coarsened by the
+                // blocking factor, which is where the clustering is done.
+                bool covered;
+                Long ntags = mesh.CheckTags(covered);
+                const IntVect bf_lev = amrex::max(IntVect(1), bf/mesh.refRatio(0));
+                Long nbfcells = amrex::coarsen(fba, mesh.refRatio(0)*bf_lev).numPts();
+                Real eff = Real(ntags) / Real(nbfcells);
+                ncells[parallel] = fba.numPts();
+
+                amrex::Print() << "  " << (parallel ? "parallel" : "serial  ")
+                               << " clustering: " << fba.size() << " boxes, "
+                               << ncells[parallel] << " cells, efficiency " << eff << "\n";
+
+                AMREX_ALWAYS_ASSERT(covered);
+                AMREX_ALWAYS_ASSERT(eff >= grid_eff[icase]);
+            }
+        }
+    }
+    amrex::Finalize();
+}
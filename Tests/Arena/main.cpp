@@ -0,0 +1,206 @@
+#include <AMReX.H>
+#include <AMReX_CArena.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+using namespace amrex;
+
+namespace {
+
+// Sizes of the temporaries in a typical MFIter loop over 16^3 tiles with
+// two ghost cells: a few small work arrays and FABs with 1, 3 and 5
+// components.
+constexpr std::array<std::size_t,6> block_sizes{ 512, 2000, 20*20*20*8,
+        3*20*20*20*8, 5*20*20*20*8, 24*24*8 };
+
+void stamp (void* p, std::size_t nbytes, std::uint64_t tag)
+{
+    std::memcpy(p, &tag, sizeof(tag));
+    std::memcpy(static_cast<char*>(p)+nbytes-sizeof(tag), &tag, sizeof(tag));
+}
+
+bool check (void const* p, std::size_t nbytes, std::uint64_t tag)
+{
+    std::uint64_t lo, hi;
+    std::memcpy(&lo, p, sizeof(tag));
+    std::memcpy(&hi, static_cast<char const*>(p)+nbytes-sizeof(tag), sizeof(tag));
+    return lo == tag && hi == tag;
+}
+
+// Each thread repeatedly allocates a set of temporaries, writes to them,
+// and frees them in an order different from the allocation order.
+// Returns the number of corrupted blocks.
+int run (CArena& arena, int nsteps)
+{
+    int nerrors = 0;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel reduction(+:nerrors)
+#endif
+    {
+        std::uint64_t const tid = OpenMP::get_thread_num();
+        std::array<void*,block_sizes.size()> ptrs;
+        for (int step = 0; step < nsteps; ++step) {
+            for (int i = 0; i < static_cast<int>(block_sizes.size()); ++i) {
+                auto n = block_sizes[(i+step) % block_sizes.size()];
+                ptrs[i] = arena.alloc(n);
+                stamp(ptrs[i], n, (tid << 48) | (std::uint64_t(step) << 8) | i);
+            }
+            for (int i = 0; i < static_cast<int>(block_sizes.size()); ++i) {
+                int j = (step % 2 == 0) ? i : static_cast<int>(block_sizes.size())-1-i;
+                auto n = block_sizes[(j+step) % block_sizes.size()];
+                if (!check(ptrs[j], n, (tid << 48) | (std::uint64_t(step) << 8) | j)) {
+                    ++nerrors;
+                }
+                arena.free(ptrs[j]);
+            }
+        }
+    }
+    return nerrors;
+}
+
+// The pattern the cache is meant for: a FAB temporary built for every tile
+// of an MFIter loop.
+void run_mfiter (MultiFab& mf, Arena* arena, int nsteps)
+{
+    for (int step = 0; step < nsteps; ++step) {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(mf,true); mfi.isValid(); ++mfi) {
+            Box const& bx = mfi.tilebox();
+            FArrayBox tmp(amrex::grow(bx,1), 3, arena);
+            auto const& t = tmp.array();
+            auto const& a = mf.array(mfi);
+            amrex::LoopOnCpu(amrex::grow(bx,1), 3, [=] (int i, int j, int k, int n) noexcept
+            {
+                t(i,j,k,n) = Real(n+1);
+            });
+            amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+            {
+                a(i,j,k) += t(i-1,j,k,0) + t(i,j+1,k,1) + t(i,j,k,2);
+            });
+        }
+    }
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int nsteps = 20000;
+        int cache_size = 8;
+        {
+            ParmParse pp;
+            pp.query("nsteps", nsteps);
+            pp.query("cache_size", cache_size);
+        }
+
+        amrex::Print() << "Running " << nsteps << " steps on " << OpenMP::get_max_threads()
+                       << " threads\n";
+
+        int nerrors = 0;
+
+        CArena arena_nocache(0, ArenaInfo{}.SetCpuMemory());
+        double t0 = amrex::second();
+        nerrors += run(arena_nocache, nsteps);
+        double t_nocache = amrex::second() - t0;
+
+        CArena arena_cache(0, ArenaInfo{}.SetCpuMemory().SetThreadCache(cache_size, 4*1024*1024));
+        t0 = amrex::second();
+        nerrors += run(arena_cache, nsteps);
+        double t_cache = amrex::second() - t0;
+
+        amrex::Print() << "  without thread cache: " << t_nocache << " s\n"
+                       << "  with    thread cache: " << t_cache << " s\n";
+        arena_cache.PrintUsage("Test Arena");
+
+        auto hm = arena_cache.threadCacheHitsMisses();
+        AMREX_ALWAYS_ASSERT(hm.first + hm.second == Long(nsteps)*Long(block_sizes.size())
+                                                    *Long(OpenMP::get_max_threads()));
+        AMREX_ALWAYS_ASSERT(hm.first > hm.second);
+
+        // All blocks are back on the free list after the caches are flushed.
+        arena_cache.flushThreadCache();
+        AMREX_ALWAYS_ASSERT(arena_cache.heap_space_actually_used() == 0);
+        arena_cache.freeUnused();
+        AMREX_ALWAYS_ASSERT(arena_cache.heap_space_used() == 0);
+
+        // FArrayBox temporaries in an MFIter loop, first with private arenas
+        // and then with The_Arena, whose cache is set up by the inputs
+        // (amrex.the_arena_thread_cache_size).  The FABs are on the host.
+#ifndef AMREX_USE_GPU
+        {
+            int n_cell = 64;
+            int max_grid_size = 32;
+            int fab_steps = 50;
+            {
+                ParmParse pp;
+                pp.query("n_cell", n_cell);
+                pp.query("max_grid_size", max_grid_size);
+                pp.query("fab_steps", fab_steps);
+            }
+            BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+            ba.maxSize(max_grid_size);
+            DistributionMapping dm(ba);
+            MultiFab mf(ba, dm, 1, 0);
+
+            CArena fab_nocache(0, ArenaInfo{}.SetCpuMemory());
+            CArena fab_cache(0, ArenaInfo{}.SetCpuMemory().SetThreadCache(cache_size, 4*1024*1024));
+
+            mf.setVal(0.0);
+            t0 = amrex::second();
+            run_mfiter(mf, &fab_nocache, fab_steps);
+            double tf_nocache = amrex::second() - t0;
+
+            t0 = amrex::second();
+            run_mfiter(mf, &fab_cache, fab_steps);
+            double tf_cache = amrex::second() - t0;
+
+            amrex::Print() << "FArrayBox temporaries in MFIter loop, " << fab_steps << " steps\n"
+                           << "  without thread cache: " << tf_nocache << " s\n"
+                           << "  with    thread cache: " << tf_cache << " s\n";
+
+            AMREX_ALWAYS_ASSERT(fab_cache.threadCacheHitsMisses().first > 0);
+            fab_cache.flushThreadCache();
+            AMREX_ALWAYS_ASSERT(fab_cache.heap_space_actually_used() == 0);
+
+            int nrounds = 2;
+            int the_arena_cache_size = 0;
+            ParmParse("amrex").query("the_arena_thread_cache_size", the_arena_cache_size);
+            auto* the_arena = dynamic_cast<CArena*>(The_Arena());
+            if (the_arena) {
+                auto hm0 = the_arena->threadCacheHitsMisses();
+                t0 = amrex::second();
+                run_mfiter(mf, The_Arena(), fab_steps);
+                double tf_the_arena = amrex::second() - t0;
+                auto hm1 = the_arena->threadCacheHitsMisses();
+                ++nrounds;
+                amrex::Print() << "  The_Arena:            " << tf_the_arena << " s, "
+                               << hm1.first-hm0.first << " cache hits\n";
+                if (the_arena_cache_size > 0) {
+                    AMREX_ALWAYS_ASSERT(hm1.first-hm0.first > hm1.second-hm0.second);
+                }
+            }
+
+            // Each step adds 1+2+3 to every cell.
+            AMREX_ALWAYS_ASSERT(mf.min(0) == Real(6*fab_steps*nrounds) &&
+                                mf.max(0) == Real(6*fab_steps*nrounds));
+        }
+#endif
+
+        if (nerrors > 0) {
+            amrex::Abort(std::to_string(nerrors) + " corrupted blocks");
+        }
+        amrex::Print() << "All tests passed\n";
+    }
+    amrex::Finalize();
+}
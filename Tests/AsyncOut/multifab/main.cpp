@@ -3,6 +3,7 @@
 #include <AMReX_VisMF.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_BLProfiler.H>
+#include <AMReX_PlotFileUtil.H>
 
 #include <thread>
 #include <future>
@@ -32,6 +33,7 @@ void main_main ()
     int max_grid_size = 64;
     int nwork = 10;
     int nwrites = 4;
+    Long max_staging_bytes = 0;
 
     {
         ParmParse pp;
@@ -42,6 +44,9 @@ void main_main ()
         pp.query("nwork", nwork);
         pp.query("nwrites", nwrites);
 
+        ParmParse ppa("amrex");
+        ppa.query("async_out_max_staging_bytes", max_staging_bytes);
+
         // inputs hierarchy:
         // n_cell > n_boxes_per_rank > n_cell_3d
 
@@ -184,8 +189,18 @@ void main_main ()
     amrex::Print() << " AsyncOut " << std::endl;
     {
         BL_PROFILE_REGION("vismf-async-overlap");
+        Long mf_bytes = 0;
+        for (MFIter mfi(mfs[0]); mfi.isValid(); ++mfi) {
+            mf_bytes += mfi.validbox().numPts() * Long(sizeof(Real));
+        }
         for (int m = 0; m < nwrites; ++m) {
             VisMF::AsyncWrite(mfs[m], std::string("vismfdata/file-" + std::to_string(m)));
+            // The staged copies are limited by amrex.async_out_max_staging_bytes,
+            // unless a single write is larger than that.
+            if (AsyncOut::UseAsyncOut() && max_staging_bytes > 0) {
+                AMREX_ALWAYS_ASSERT(AsyncOut::StagingBytes()
+                                    <= std::max(max_staging_bytes, mf_bytes));
+            }
         }
         {
             BL_PROFILE_VAR("vismf-async-work", blp2);
@@ -206,4 +221,50 @@ void main_main ()
         }
     }
     ParallelDescriptor::Barrier();
+
+// ***************************************************************
+
+    amrex::Print() << " AsyncOut multi-level plotfile " << std::endl;
+    {
+        BL_PROFILE_REGION("plotfile-async");
+
+        const int nlevels = 2;
+        const IntVect ratio(2);
+        const Box domain = ba.minimalBox();
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Vector<Geometry> geom(nlevels);
+        geom[0].define(domain, rb, CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+        geom[1].define(amrex::refine(domain,ratio), rb, CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+
+        // The fine level covers the middle half of the domain.
+        Box fbx = amrex::refine(domain,ratio);
+        fbx.grow(-fbx.length()/4);
+        BoxArray fba(fbx);
+        fba.maxSize(max_grid_size);
+        MultiFab fine(fba, DistributionMapping(fba), 1, 0);
+        fine.setVal(2.0);
+
+        Vector<const MultiFab*> mf{&mfs[0], &fine};
+        AsyncOut::WriteHandle handle;
+        {
+            BL_PROFILE_VAR("plotfile-async-write", blp1);
+            WriteMultiLevelPlotfile("vismfdata/plt-async", nlevels, mf, {"phi"}, geom, 0.0,
+                                    Vector<int>(nlevels,0), Vector<IntVect>(nlevels-1,ratio));
+            handle = AsyncOut::GetWriteHandle();
+        }
+        {
+            BL_PROFILE_VAR("plotfile-async-wait", blp2);
+            handle.wait();
+        }
+        AMREX_ALWAYS_ASSERT(handle.isReady());
+        AMREX_ALWAYS_ASSERT(AsyncOut::StagingBytes() == 0);
+        ParallelDescriptor::Barrier();
+
+        MultiFab crse_in, fine_in;
+        VisMF::Read(crse_in, "vismfdata/plt-async/Level_0/Cell");
+        VisMF::Read(fine_in, "vismfdata/plt-async/Level_1/Cell");
+        AMREX_ALWAYS_ASSERT(crse_in.min(0) == mf_min[0] && crse_in.max(0) == mf_max[0]);
+        AMREX_ALWAYS_ASSERT(fine_in.min(0) == 2.0 && fine_in.max(0) == 2.0);
+    }
+    ParallelDescriptor::Barrier();
 }
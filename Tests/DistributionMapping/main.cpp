@@ -0,0 +1,159 @@
+#include <AMReX.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+using namespace amrex;
+
+namespace {
+
+// Boxes in a spherical shell, with a few of them chopped further, so that
+// they have different sizes.
+BoxArray make_boxes (int n_cell, int max_grid_size)
+{
+    BoxArray ba0(Box(IntVect(0), IntVect(n_cell-1)));
+    ba0.maxSize(max_grid_size);
+    BoxList bl;
+    const Real rc = 0.5_rt*n_cell;
+    for (int i = 0; i < ba0.size(); ++i) {
+        const Box& bx = ba0[i];
+        Real r2 = 0;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            Real x = 0.5_rt*(bx.smallEnd(idim)+bx.bigEnd(idim)+1) - rc;
+            r2 += x*x;
+        }
+        if (r2 < 0.45_rt*0.45_rt*n_cell*n_cell && r2 > 0.25_rt*0.25_rt*n_cell*n_cell) {
+            if (i % 7 == 0) {
+                BoxList bl2(bx);
+                bl2.maxSize(max_grid_size/2);
+                bl.join(bl2);
+            } else {
+                bl.push_back(bx);
+            }
+        }
+    }
+    return BoxArray(std::move(bl));
+}
+
+void report (std::string const& name, DistributionMapping const& dm, BoxArray const& ba,
+             int nprocs, Real eff)
+{
+    for (int i = 0; i < dm.size(); ++i) {
+        AMREX_ALWAYS_ASSERT(dm[i] >= 0 && dm[i] < nprocs);
+    }
+    amrex::Print() << "  " << name << ": efficiency " << eff << ", halo bytes "
+                   << DistributionMapping::ComputeDistributionMappingHaloBytes(dm, ba)
+                   << "\n";
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 128;
+        int max_grid_size = 16;
+        int nprocs = 32;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nprocs", nprocs);
+        }
+
+        // The distributions are not sorted by memory use, so that they can
+        // be computed for more processes than we have.
+        BoxArray ba = make_boxes(n_cell, max_grid_size);
+        std::vector<Long> wgts(ba.size());
+        for (int i = 0; i < ba.size(); ++i) {
+            wgts[i] = ba[i].numPts();
+        }
+
+        amrex::Print() << ba.size() << " boxes on " << nprocs << " processes\n";
+
+        // Round robin, as a baseline without any locality
+        Vector<int> pmap(ba.size());
+        Vector<Long> load(nprocs, 0);
+        for (int i = 0; i < ba.size(); ++i) {
+            pmap[i] = i % nprocs;
+            load[i % nprocs] += wgts[i];
+        }
+        DistributionMapping dm_rr(pmap);
+        Real eff_rr = Real(std::accumulate(load.begin(), load.end(), Long(0)))
+            / Real(nprocs * *std::max_element(load.begin(), load.end()));
+
+        Real eff_hilbert, eff_graph;
+        DistributionMapping dm_hilbert, dm_graph;
+        dm_hilbert.HilbertProcessorMap(ba, wgts, nprocs, eff_hilbert, false);
+        dm_graph.GraphProcessorMap(ba, wgts, nprocs, eff_graph, false);
+
+        report("ROUNDROBIN", dm_rr, ba, nprocs, eff_rr);
+        report("HILBERT   ", dm_hilbert, ba, nprocs, eff_hilbert);
+        report("GRAPH     ", dm_graph, ba, nprocs, eff_graph);
+
+        Real eff_node;
+        DistributionMapping dm_node;
+        dm_node.NodeAwareProcessorMap(ba, wgts, nprocs, eff_node);
+        report("NODEAWARE ", dm_node, ba, nprocs, eff_node);
+
+        // GRAPH does not make the load balance worse.
+        AMREX_ALWAYS_ASSERT(eff_graph >= eff_hilbert*(1.0_rt-1.e-12_rt));
+
+#ifdef AMREX_USE_MPI
+        auto halo_rr = DistributionMapping::ComputeDistributionMappingHaloBytes(dm_rr, ba);
+        auto halo_hilbert = DistributionMapping::ComputeDistributionMappingHaloBytes(dm_hilbert, ba);
+        auto halo_graph = DistributionMapping::ComputeDistributionMappingHaloBytes(dm_graph, ba);
+        AMREX_ALWAYS_ASSERT(halo_hilbert < halo_rr);
+        AMREX_ALWAYS_ASSERT(halo_graph <= halo_hilbert);
+
+        // NODEAWARE keeps more of the communication within the nodes.
+        {
+            Long intra_graph, inter_graph, intra_node, inter_node;
+            DistributionMapping::ComputeDistributionMappingNodeHaloBytes
+                (dm_graph, ba, intra_graph, inter_graph);
+            DistributionMapping::ComputeDistributionMappingNodeHaloBytes
+                (dm_node, ba, intra_node, inter_node);
+            amrex::Print() << "  GRAPH     intra-node " << intra_graph
+                           << ", inter-node " << inter_graph << " bytes\n"
+                           << "  NODEAWARE intra-node " << intra_node
+                           << ", inter-node " << inter_node << " bytes\n";
+            AMREX_ALWAYS_ASSERT(intra_graph + inter_graph == halo_graph);
+            AMREX_ALWAYS_ASSERT(intra_node + inter_node ==
+                DistributionMapping::ComputeDistributionMappingHaloBytes(dm_node, ba));
+            AMREX_ALWAYS_ASSERT(inter_node <= inter_graph);
+        }
+
+        // With one box per process on a regular grid of 2^n boxes per
+        // direction, consecutive boxes on the Hilbert curve share a face.
+        {
+            BoxArray bar(Box(IntVect(0), IntVect(8*max_grid_size-1)));
+            bar.maxSize(max_grid_size);
+            std::vector<Long> w(bar.size(), 1L);
+            DistributionMapping dm;
+            dm.HilbertProcessorMap(bar, w, bar.size(), false);
+            Vector<int> box_of_rank(bar.size());
+            for (int i = 0; i < bar.size(); ++i) {
+                box_of_rank[dm[i]] = i;
+            }
+            for (int r = 0; r+1 < bar.size(); ++r) {
+                const Box& b0 = bar[box_of_rank[r]];
+                const Box& b1 = bar[box_of_rank[r+1]];
+                int nfaces = 0;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    if (amrex::grow(b0,idim,1).intersects(b1)) { ++nfaces; }
+                }
+                AMREX_ALWAYS_ASSERT(nfaces == 1);
+            }
+        }
+#endif
+
+        amrex::Print() << "DistributionMapping test passed\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,148 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_EB_STL_utils.H>
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+
+using namespace amrex;
+
+namespace {
+
+// Write a tessellated sphere as a binary STL file.  The vertices of each
+// triangle are ordered counterclockwise when viewed from outside.
+void write_sphere_stl (std::string const& fname, int ntheta, int nphi, Real radius)
+{
+    auto pt = [=] (int it, int ip) -> Array<float,3>
+    {
+        double theta = M_PI * it / ntheta;
+        double phi = 2.0 * M_PI * ip / nphi;
+        return {static_cast<float>(0.5 + radius*std::sin(theta)*std::cos(phi)),
+                static_cast<float>(0.5 + radius*std::sin(theta)*std::sin(phi)),
+                static_cast<float>(0.5 + radius*std::cos(theta))};
+    };
+
+    Vector<Array<Array<float,3>,3> > tris;
+    for (int it = 0; it < ntheta; ++it) {
+        for (int ip = 0; ip < nphi; ++ip) {
+            auto a = pt(it  ,ip  );
+            auto b = pt(it+1,ip  );
+            auto c = pt(it+1,ip+1);
+            auto d = pt(it  ,ip+1);
+            if (it != ntheta-1) { tris.push_back({a,b,c}); }
+            if (it != 0)        { tris.push_back({a,c,d}); }
+        }
+    }
+
+    std::ofstream ofs(fname, std::ios::binary);
+    char header[80] = {};
+    ofs.write(header, 80);
+    auto ntris = static_cast<std::uint32_t>(tris.size());
+    ofs.write(reinterpret_cast<char const*>(&ntris), sizeof(ntris));
+    for (auto const& tri : tris) {
+        float normal[3] = {0.f, 0.f, 0.f};
+        ofs.write(reinterpret_cast<char const*>(normal), sizeof(normal));
+        for (auto const& v : tri) {
+            ofs.write(reinterpret_cast<char const*>(v.data()), 3*sizeof(float));
+        }
+        std::uint16_t attr = 0;
+        ofs.write(reinterpret_cast<char const*>(&attr), sizeof(attr));
+    }
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 16;
+        int ntheta = 48;
+        int nphi = 48;
+        Real sphere_radius = 0.3_rt;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("ntheta", ntheta);
+            pp.query("nphi", nphi);
+            pp.query("sphere_radius", sphere_radius);
+        }
+
+        const std::string stl_file("sphere.stl");
+        if (ParallelDescriptor::IOProcessor()) {
+            write_sphere_stl(stl_file, ntheta, nphi, sphere_radius);
+        }
+        ParallelDescriptor::Barrier();
+
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0._rt,0._rt,0._rt)}, {AMREX_D_DECL(1._rt,1._rt,1._rt)});
+        Geometry geom(domain, rb, 0, {AMREX_D_DECL(0,0,0)});
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        ParmParse pp_eb2("eb2");
+        pp_eb2.add("geom_type", std::string("stl"));
+        pp_eb2.add("stl_file", stl_file);
+
+        Array<MultiFab,2> inout;
+        Array<MultiFab,2> vfrac;
+        Array<Real,2> t_prepare, t_fill, t_build;
+
+        // 0: brute force, 1: BVH
+        for (int use_bvh = 0; use_bvh < 2; ++use_bvh)
+        {
+            pp_eb2.add("stl_use_bvh", use_bvh);
+
+            Real t0 = amrex::second();
+            STLtools stl;
+            stl.read_stl_file(stl_file, 1._rt, {0._rt,0._rt,0._rt}, 0);
+            Real t1 = amrex::second();
+
+            inout[use_bvh].define(ba, dm, 1, 0);
+            stl.fill(inout[use_bvh], IntVect(0), geom);
+            Real t2 = amrex::second();
+
+            EB2::Build(geom, 0, 0);
+            Real t3 = amrex::second();
+
+            auto factory = makeEBFabFactory(geom, ba, dm, {1,1,1}, EBSupport::volume);
+            vfrac[use_bvh].define(ba, dm, 1, 0);
+            MultiFab::Copy(vfrac[use_bvh], factory->getVolFrac(), 0, 0, 1, 0);
+            EB2::IndexSpace::clear();
+
+            t_prepare[use_bvh] = t1 - t0;
+            t_fill[use_bvh] = t2 - t1;
+            t_build[use_bvh] = t3 - t2;
+            ParallelDescriptor::ReduceRealMax(t_prepare[use_bvh]);
+            ParallelDescriptor::ReduceRealMax(t_fill[use_bvh]);
+            ParallelDescriptor::ReduceRealMax(t_build[use_bvh]);
+
+            if (use_bvh) {
+                amrex::Print() << "  Number of triangles: " << stl.numTriangles()
+                               << ", number of BVH nodes: " << stl.numBVHNodes() << "\n";
+            }
+        }
+
+        amrex::Print() << "                  brute force        BVH\n"
+                       << "  prepare   : " << t_prepare[0] << "  " << t_prepare[1] << "\n"
+                       << "  fill      : " << t_fill[0] << "  " << t_fill[1] << "\n"
+                       << "  EB2::Build: " << t_build[0] << "  " << t_build[1] << "\n";
+
+        MultiFab::Subtract(inout[1], inout[0], 0, 0, 1, 0);
+        MultiFab::Subtract(vfrac[1], vfrac[0], 0, 0, 1, 0);
+        Real inout_diff = inout[1].norm0();
+        Real vfrac_diff = vfrac[1].norm0();
+        amrex::Print() << "  max difference in inside/outside: " << inout_diff << "\n"
+                       << "  max difference in volume fraction: " << vfrac_diff << "\n";
+        AMREX_ALWAYS_ASSERT(inout_diff == 0._rt);
+        AMREX_ALWAYS_ASSERT(vfrac_diff < 1.e-12_rt);
+    }
+    amrex::Finalize();
+}
@@ -1,10 +1,12 @@
 #include <AMReX_Utility.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_MultiFab.H>
+#include <AMReX_iMultiFab.H>
 #include <AMReX_ParmParse.H>
 
 #include <algorithm>
 #include <fstream>
+#include <string>
 
 #ifdef AMREX_USE_OMP
 #include <omp.h>
@@ -125,41 +127,150 @@ main (int argc, char* argv[])
     }
 
     int nrounds = 1000;
+    // With compare = 1, the communication is timed and checked with each
+    // transport: point-to-point messages, persistent requests, and
+    // neighborhood collectives.
+    int compare = 0;
     {
         ParmParse pp;
         pp.query("nrounds", nrounds);
+        pp.query("compare", compare);
     }
 
-    Real err = 0.0;
+    struct Transport {
+        std::string name;
+        bool persistent_requests;
+        bool neighbor_collectives;
+    };
+    Vector<Transport> transports;
+    if (compare) {
+        transports.push_back({"point-to-point", false, false});
+        transports.push_back({"persistent requests", true, false});
+        transports.push_back({"neighbor collectives", false, true});
+    } else {
+        transports.push_back({"default", FabArrayBase::fb_persistent_requests,
+                              FabArrayBase::neighbor_collectives});
+    }
 
-    ParallelDescriptor::Barrier();
-    auto wt0 = ParallelDescriptor::second();
+    // The values of valid cells
+    auto fval = [] AMREX_GPU_HOST_DEVICE (int i, int j, int k, int n) noexcept -> Real
+    {
+        return i + 1000.*j + 1.e6*k + 1.e9*n;
+    };
+
+    // Ghost cells covered by the BoxArray
+    const int ncomp = 2;
+    iMultiFab covered(ba, dm, 1, 2);
+    covered.setVal(0);
+    for (MFIter mfi(covered); mfi.isValid(); ++mfi) {
+        for (auto const& is : ba.intersections(mfi.fabbox())) {
+            covered[mfi].setVal<RunOn::Device>(1, is.second);
+        }
+    }
 
-    for (int iround = 0; iround < nrounds; ++iround) {
-        for (int c=0; c<2; ++c) {
-            for (int lev = 0; lev < nlevels; ++lev) {
-                mfs[lev]->FillBoundary_nowait();
-                mfs[lev]->FillBoundary_finish();
+    // A shifted DistributionMapping for checking ParallelCopy
+    Vector<int> pmap = dm.ProcessorMap();
+    for (auto& p : pmap) {
+        p = (p + 1) % ParallelDescriptor::NProcs();
+    }
+    DistributionMapping dm2(std::move(pmap));
+
+    for (auto const& transport : transports)
+    {
+        FabArrayBase::fb_persistent_requests = transport.persistent_requests;
+        FabArrayBase::neighbor_collectives = transport.neighbor_collectives;
+
+        Real err = 0.0;
+
+        ParallelDescriptor::Barrier();
+        auto wt0 = ParallelDescriptor::second();
+
+        for (int iround = 0; iround < nrounds; ++iround) {
+            for (int c=0; c<2; ++c) {
+                for (int lev = 0; lev < nlevels; ++lev) {
+                    mfs[lev]->FillBoundary_nowait();
+                    mfs[lev]->FillBoundary_finish();
+                }
+                for (int lev = nlevels-1; lev >= 0; --lev) {
+                    mfs[lev]->FillBoundary_nowait();
+                    mfs[lev]->FillBoundary_finish();
+                }
             }
-            for (int lev = nlevels-1; lev >= 0; --lev) {
-                mfs[lev]->FillBoundary_nowait();
-                mfs[lev]->FillBoundary_finish();
+            Real e = double(iround+ParallelDescriptor::MyProc());
+            ParallelDescriptor::ReduceRealMax(e);
+            err += e;
+        }
+
+        ParallelDescriptor::Barrier();
+        auto wt1 = ParallelDescriptor::second();
+
+        if (ParallelDescriptor::IOProcessor()) {
+            std::cout << "Using MPI with " << transport.name << std::endl;
+            std::cout << "----------------------------------------------" << std::endl;
+            std::cout << "Fill Boundary Time: " << wt1-wt0 << std::endl;
+            std::cout << "----------------------------------------------" << std::endl;
+            std::cout << "ignore this line " << err << std::endl;
+        }
+
+        //
+        // Check the ghost cells.  A ghost cell covered by the BoxArray must
+        // be filled with the value of the valid cell, and the others must
+        // keep the value set by setBndry.
+        //
+        MultiFab mf(ba, dm, ncomp, 2);
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            auto const& a = mf.array(mfi);
+            amrex::ParallelFor(bx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n)
+            {
+                a(i,j,k,n) = fval(i,j,k,n);
+            });
+        }
+
+        Long nbad = 0;
+        for (int iround = 0; iround < 2; ++iround) {
+            mf.setBndry(-1.0);
+            mf.FillBoundary();
+
+            for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                const Box& bx = mfi.fabbox();
+                auto const& a = mf.const_array(mfi);
+                auto const& c = covered.const_array(mfi);
+                nbad += amrex::Reduce::Sum<Long>(bx.numPts()*ncomp,
+                    [=] AMREX_GPU_DEVICE (Long icell) noexcept -> Long
+                    {
+                        auto n = static_cast<int>(icell / bx.numPts());
+                        auto iv = bx.atOffset3d(icell - n*bx.numPts());
+                        Real v = a(iv[0],iv[1],iv[2],n);
+                        Real expected = (c(iv[0],iv[1],iv[2]) == 1)
+                            ? fval(iv[0],iv[1],iv[2],n) : -1.0;
+                        return (v == expected) ? 0 : 1;
+                    });
             }
         }
-        Real e = double(iround+ParallelDescriptor::MyProc());
-        ParallelDescriptor::ReduceRealMax(e);
-        err += e;
-    }
 
-    ParallelDescriptor::Barrier();
-    auto wt1 = ParallelDescriptor::second();
-
-    if (ParallelDescriptor::IOProcessor()) {
-        std::cout << "Using MPI" << std::endl;
-        std::cout << "----------------------------------------------" << std::endl;
-        std::cout << "Fill Boundary Time: " << wt1-wt0 << std::endl;
-        std::cout << "----------------------------------------------" << std::endl;
-        std::cout << "ignore this line " << err << std::endl;
+        MultiFab mf2(ba, dm2, ncomp, 0);
+        mf2.setVal(-1.0);
+        mf2.ParallelCopy(mf);
+        for (MFIter mfi(mf2); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            auto const& a = mf2.const_array(mfi);
+            nbad += amrex::Reduce::Sum<Long>(bx.numPts()*ncomp,
+                [=] AMREX_GPU_DEVICE (Long icell) noexcept -> Long
+                {
+                    auto n = static_cast<int>(icell / bx.numPts());
+                    auto iv = bx.atOffset3d(icell - n*bx.numPts());
+                    return (a(iv[0],iv[1],iv[2],n) == fval(iv[0],iv[1],iv[2],n)) ? 0 : 1;
+                });
+        }
+
+        ParallelDescriptor::ReduceLongSum(nbad);
+        if (nbad > 0) {
+            amrex::Abort("FillBoundary and ParallelCopy check failed with " + transport.name);
+        }
+        if (ParallelDescriptor::IOProcessor()) {
+            std::cout << "FillBoundary and ParallelCopy check passed" << std::endl;
+        }
     }
 
     //
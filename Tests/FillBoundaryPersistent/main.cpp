@@ -0,0 +1,138 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_iMultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+namespace {
+
+void init (MultiFab& mf, int iround)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        auto const& a = mf.array(mfi);
+        amrex::ParallelFor(bx, mf.nComp(), [=] AMREX_GPU_DEVICE (int i, int j, int k, int n)
+        {
+            a(i,j,k,n) = i + 1000.*j + 1.e6*k + 1.e9*(n+iround);
+        });
+    }
+    mf.setBndry(-1.0);
+}
+
+// A ghost cell covered by the BoxArray must have the value of the valid
+// cell, and the others must keep the value set by setBndry.
+Long check (MultiFab const& mf, iMultiFab const& covered, int iround)
+{
+    Long nbad = 0;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.fabbox();
+        const int ncomp = mf.nComp();
+        auto const& a = mf.const_array(mfi);
+        auto const& c = covered.const_array(mfi);
+        nbad += amrex::Reduce::Sum<Long>(bx.numPts()*ncomp,
+            [=] AMREX_GPU_DEVICE (Long icell) noexcept -> Long
+            {
+                auto n = static_cast<int>(icell / bx.numPts());
+                auto iv = bx.atOffset3d(icell - n*bx.numPts());
+                Real expected = (c(iv[0],iv[1],iv[2]) == 1)
+                    ? iv[0] + 1000.*iv[1] + 1.e6*iv[2] + 1.e9*(n+iround) : -1.0;
+                return (a(iv[0],iv[1],iv[2],n) == expected) ? 0 : 1;
+            });
+    }
+    ParallelDescriptor::ReduceLongSum(nbad);
+    return nbad;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int nrounds = 3;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nrounds", nrounds);
+        }
+
+        // Drop some boxes so that some ghost cells are not covered.
+        BoxArray ba0(Box(IntVect(0), IntVect(n_cell-1)));
+        ba0.maxSize(max_grid_size);
+        BoxList bl;
+        for (int i = 0; i < ba0.size(); ++i) {
+            if (i % 5 != 3) { bl.push_back(ba0[i]); }
+        }
+        BoxArray ba(std::move(bl));
+        DistributionMapping dm(ba);
+
+        const int ng = 2;
+        iMultiFab covered(ba, dm, 1, ng);
+        covered.setVal(0);
+        for (MFIter mfi(covered); mfi.isValid(); ++mfi) {
+            for (auto const& is : ba.intersections(mfi.fabbox())) {
+                covered[mfi].setVal<RunOn::Device>(1, is.second);
+            }
+        }
+
+        // mf1 and mf2 share the same FB.  mf3 has a different message size.
+        MultiFab mf1(ba, dm, 2, ng);
+        MultiFab mf2(ba, dm, 2, ng);
+        MultiFab mf3(ba, dm, 1, ng);
+
+        Long nbad = 0;
+        // Point-to-point, persistent requests, and neighborhood collectives
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            FabArrayBase::fb_persistent_requests = (mode == 1);
+            FabArrayBase::neighbor_collectives = (mode == 2);
+
+            for (int iround = 0; iround < nrounds; ++iround)
+            {
+                init(mf1, iround);
+                init(mf2, iround+1);
+                init(mf3, iround+2);
+
+                // The second one has to fall back to the regular path
+                // while the first one is in progress.
+                mf1.FillBoundary_nowait();
+                mf2.FillBoundary_nowait();
+                mf3.FillBoundary_nowait();
+                mf2.FillBoundary_finish();
+                mf1.FillBoundary_finish();
+                mf3.FillBoundary_finish();
+
+                nbad += check(mf1, covered, iround);
+                nbad += check(mf2, covered, iround+1);
+                nbad += check(mf3, covered, iround+2);
+
+                init(mf1, iround+3);
+                mf1.FillBoundary();
+                nbad += check(mf1, covered, iround+3);
+            }
+        }
+
+        if (nbad > 0) {
+            amrex::Abort("FillBoundary with persistent requests or neighborhood collectives failed");
+        }
+
+#ifdef AMREX_USE_MPI
+        if (ParallelDescriptor::NProcs() > 1) {
+            auto const& stats = FabArrayBase::m_FBPC_stats;
+            // One for each message size, reused by all later calls that
+            // did not fall back.
+            AMREX_ALWAYS_ASSERT(stats.nbuild == 2);
+            AMREX_ALWAYS_ASSERT(stats.nuse == 3*nrounds);
+        }
+#endif
+
+        amrex::Print() << "FillBoundary with persistent requests and neighborhood collectives passed"
+                       << std::endl;
+    }
+    amrex::Finalize();
+}
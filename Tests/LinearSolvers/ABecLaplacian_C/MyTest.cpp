@@ -15,6 +15,56 @@ MyTest::MyTest ()
 
 void
 MyTest::solve ()
+{
+    if (!compare_mixed_precision) {
+        solveProblem();
+        return;
+    }
+
+    // Solve in double precision and then with a single precision V-cycle
+    // from the same initial data, and compare the errors.
+    const int nlevels = geom.size();
+    Vector<MultiFab> solution0(nlevels);
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        solution0[ilev].define(grids[ilev], dmap[ilev], 1, solution[ilev].nGrowVect());
+        MultiFab::Copy(solution0[ilev], solution[ilev], 0, 0, 1, solution[ilev].nGrowVect());
+    }
+
+    mixed_precision = false;
+    solveProblem();
+    const Vector<Real> err_double = errorNorms();
+
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        MultiFab::Copy(solution[ilev], solution0[ilev], 0, 0, 1, solution[ilev].nGrowVect());
+    }
+
+    mixed_precision = true;
+    solveProblem();
+    const Vector<Real> err_mixed = errorNorms();
+
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        amrex::Print() << "Level " << ilev << " max error: double precision " << err_double[ilev]
+                       << ", mixed precision " << err_mixed[ilev] << "\n";
+        AMREX_ALWAYS_ASSERT(std::abs(err_mixed[ilev]-err_double[ilev]) <= Real(1.e-3)*err_double[ilev]);
+    }
+}
+
+Vector<Real>
+MyTest::errorNorms () const
+{
+    const int nlevels = geom.size();
+    Vector<Real> r(nlevels);
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        MultiFab err(grids[ilev], dmap[ilev], 1, 0);
+        MultiFab::Copy(err, solution[ilev], 0, 0, 1, 0);
+        MultiFab::Subtract(err, exact_solution[ilev], 0, 0, 1, 0);
+        r[ilev] = err.norm0();
+    }
+    return r;
+}
+
+void
+MyTest::solveProblem ()
 {
     if (prob_type == 1) {
         solvePoisson();
@@ -65,6 +115,8 @@ MyTest::solvePoisson ()
         mlmg.setMaxFmgIter(max_fmg_iter);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
+        mlmg.setMixedPrecision(mixed_precision);
+        mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
         if (use_hypre) {
             mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -106,6 +158,8 @@ MyTest::solvePoisson ()
             mlmg.setMaxFmgIter(max_fmg_iter);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
+            mlmg.setMixedPrecision(mixed_precision);
+            mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
             if (use_hypre) {
                 mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -182,6 +236,8 @@ MyTest::solveABecLaplacian ()
         mlmg.setMaxFmgIter(max_fmg_iter);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
+        mlmg.setMixedPrecision(mixed_precision);
+        mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
         if (use_hypre) {
             mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -239,6 +295,8 @@ MyTest::solveABecLaplacian ()
             mlmg.setMaxFmgIter(max_fmg_iter);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
+            mlmg.setMixedPrecision(mixed_precision);
+            mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
             if (use_hypre) {
                 mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -324,6 +382,8 @@ MyTest::solveABecLaplacianInhomNeumann ()
         mlmg.setMaxFmgIter(max_fmg_iter);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
+        mlmg.setMixedPrecision(mixed_precision);
+        mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
         if (use_hypre) {
             mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -381,6 +441,8 @@ MyTest::solveABecLaplacianInhomNeumann ()
             mlmg.setMaxFmgIter(max_fmg_iter);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
+            mlmg.setMixedPrecision(mixed_precision);
+            mlmg.setBottomSolver(bottom_solver);
 #ifdef AMREX_USE_HYPRE
             if (use_hypre) {
                 mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -432,6 +494,28 @@ MyTest::readParameters ()
     pp.query("semicoarsening", semicoarsening);
     pp.query("max_coarsening_level", max_coarsening_level);
     pp.query("max_semicoarsening_level", max_semicoarsening_level);
+    pp.query("mixed_precision", mixed_precision);
+    pp.query("compare_mixed_precision", compare_mixed_precision);
+
+    std::string bottom_solver_s = "default";
+    pp.query("bottom_solver", bottom_solver_s);
+    if (bottom_solver_s == "default") {
+        bottom_solver = BottomSolver::Default;
+    } else if (bottom_solver_s == "smoother") {
+        bottom_solver = BottomSolver::smoother;
+    } else if (bottom_solver_s == "bicgstab") {
+        bottom_solver = BottomSolver::bicgstab;
+    } else if (bottom_solver_s == "cg") {
+        bottom_solver = BottomSolver::cg;
+    } else if (bottom_solver_s == "pipebicgstab") {
+        bottom_solver = BottomSolver::pipebicgstab;
+    } else if (bottom_solver_s == "pipecg") {
+        bottom_solver = BottomSolver::pipecg;
+    } else if (bottom_solver_s == "sstepcg") {
+        bottom_solver = BottomSolver::sstepcg;
+    } else {
+        amrex::Abort("Unknown bottom_solver: " + bottom_solver_s);
+    }
 
 #ifdef AMREX_USE_HYPRE
     pp.query("use_hypre", use_hypre);
@@ -0,0 +1,137 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_MLABecLaplacian.H>
+#include <AMReX_MLMG.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+namespace {
+
+void setup_linop (MLABecLaplacian& mlabec, MultiFab const& acoef)
+{
+    mlabec.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                     LinOpBCType::Dirichlet,
+                                     LinOpBCType::Dirichlet)},
+                       {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                     LinOpBCType::Dirichlet,
+                                     LinOpBCType::Dirichlet)});
+    mlabec.setLevelBC(0, nullptr);
+    mlabec.setScalars(1.0, 1.0);
+    // Single component coefficients are shared by all components.
+    mlabec.setACoeffs(0, acoef);
+    mlabec.setBCoeffs(0, 1.0);
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 32;
+        int nrhs = 8;
+        int verbose = 1;
+        Real tol_rel = 1.e-10;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nrhs", nrhs);
+            pp.query("verbose", verbose);
+            pp.query("tol_rel", tol_rel);
+        }
+
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        Geometry geom(domain, rb, CoordSys::cartesian, is_periodic);
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        MultiFab acoef(ba, dm, 1, 0);
+        Vector<MultiFab> rhs(nrhs);
+        Vector<MultiFab> sol_single(nrhs);
+        Vector<MultiFab> sol_batch(nrhs);
+        const auto dx = geom.CellSizeArray();
+        for (int n = 0; n < nrhs; ++n)
+        {
+            rhs[n].define(ba, dm, 1, 0);
+            sol_single[n].define(ba, dm, 1, 1);
+            sol_batch[n].define(ba, dm, 1, 1);
+            sol_single[n].setVal(0.0);
+            sol_batch[n].setVal(0.0);
+            const Real freq = Real(n+1)*Real(3.14159265358979323846);
+            for (MFIter mfi(rhs[n]); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.validbox();
+                auto const& r = rhs[n].array(mfi);
+                auto const& a = acoef.array(mfi);
+                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                {
+                    const Real x = (i+0.5)*dx[0];
+                    const Real y = (j+0.5)*dx[1];
+#if (AMREX_SPACEDIM == 3)
+                    const Real z = (k+0.5)*dx[2];
+#else
+                    const Real z = 0.5;
+                    amrex::ignore_unused(k);
+#endif
+                    r(i,j,k) = std::sin(freq*x) * std::cos(2.0*y) + x*y*z;
+                    a(i,j,k) = 1.0 + x*x;
+                });
+            }
+        }
+
+        LPInfo info;
+
+        double t_single = amrex::second();
+        {
+            MLABecLaplacian mlabec({geom}, {ba}, {dm}, info);
+            setup_linop(mlabec, acoef);
+            MLMG mlmg(mlabec);
+            mlmg.setVerbose(verbose);
+            for (int n = 0; n < nrhs; ++n) {
+                mlmg.solve({&sol_single[n]}, {&rhs[n]}, tol_rel, 0.0);
+            }
+        }
+        t_single = amrex::second() - t_single;
+
+        double t_batch = amrex::second();
+        {
+            MLABecLaplacian mlabec({geom}, {ba}, {dm}, info, {}, nrhs);
+            setup_linop(mlabec, acoef);
+            MLMG mlmg(mlabec);
+            mlmg.setVerbose(verbose);
+            Vector<Vector<MultiFab*> > psol(nrhs);
+            Vector<Vector<MultiFab const*> > prhs(nrhs);
+            for (int n = 0; n < nrhs; ++n) {
+                psol[n] = {&sol_batch[n]};
+                prhs[n] = {&rhs[n]};
+            }
+            mlmg.solveBatch(psol, prhs, tol_rel, 0.0);
+        }
+        t_batch = amrex::second() - t_batch;
+
+        ParallelDescriptor::ReduceRealMax(t_single);
+        ParallelDescriptor::ReduceRealMax(t_batch);
+        amrex::Print() << "Time for " << nrhs << " separate solves: " << t_single
+                       << ", batched solve: " << t_batch << "\n";
+
+        for (int n = 0; n < nrhs; ++n)
+        {
+            const Real norm = sol_single[n].norm0();
+            MultiFab::Subtract(sol_batch[n], sol_single[n], 0, 0, 1, 0);
+            const Real diff = sol_batch[n].norm0();
+            amrex::Print() << "System " << n << ": max |sol| = " << norm
+                           << ", max |batched - separate| = " << diff << "\n";
+            AMREX_ALWAYS_ASSERT(diff <= 1.e3*tol_rel*norm);
+        }
+    }
+    amrex::Finalize();
+}
@@ -1,4 +1,5 @@
 #include <AMReX.H>
+#include <AMReX_FArrayBox.H>
 #include <AMReX_Parser.H>
 #include <AMReX_IParser.H>
 #include <map>
@@ -89,6 +90,38 @@ int test3 (std::string const& f,
             ++nfail;
         }
     }}}
+
+    // Batched evaluation over a box must agree with point-wise evaluation.
+    Box bx(IntVect(0), IntVect(AMREX_D_DECL(N*N*N-1,0,0)));
+    FArrayBox fab(bx, 2, The_Pinned_Arena());
+    auto const& a = fab.array();
+    GpuArray<Real,3> plo{lo[0], lo[1], lo[2]};
+    auto vars = [=] AMREX_GPU_HOST_DEVICE (int i, int, int) -> GpuArray<double,3>
+    {
+        int k = i % N;
+        int j = (i / N) % N;
+        int ii = i / (N*N);
+        return {plo[0] + ii*dx[0], plo[1] + j*dx[1], plo[2] + k*dx[2]};
+    };
+    Real t0 = amrex::second();
+    for (int i = 0; i < N*N*N; ++i) {
+        a(i,0,0,0) = static_cast<Real>(exe(vars(i,0,0)));
+    }
+    Real t1 = amrex::second();
+    exe.fill(fab, bx, 1, vars);
+    Gpu::streamSynchronize();
+    Real t2 = amrex::second();
+    for (int i = 0; i < N*N*N; ++i) {
+        Real abserror = std::abs(a(i,0,0,0)-a(i,0,0,1));
+        Real relerror = abserror / (1.e-50 + std::max(std::abs(a(i,0,0,0)),std::abs(a(i,0,0,1))));
+        if (abserror > abstol && relerror > reltol) {
+            amrex::Print() << "    batch f(" << i << ") = " << a(i,0,0,1) << ", "
+                           << a(i,0,0,0) << "\n";
+            ++nfail;
+        }
+    }
+    amrex::Print() << "\n    point-wise " << t1-t0 << " s, batched " << t2-t1 << " s  ";
+
     if (nfail > 0) {
         amrex::Print() << "    failed " << nfail << " times\n";
         return 1;
@@ -356,6 +389,28 @@ int main (int argc, char* argv[])
                         {0.e-6, 0.0, -20.e-6}, {20.e-6, 1.e-10, 20.e-6}, 100,
                         1.e-12, 1.e-15);
 
+        nerror += test3("sin(x*y+z)*cos(x*y+z) + sin(x*y+z)^2 + exp(-(x*x+y*y)) * (1+exp(-(x*x+y*y)))",
+                        {},
+                        {"x","y","z"},
+                        [=] (Real x, Real y, Real z) -> Real {
+                            Real s = std::sin(x*y+z);
+                            Real e = std::exp(-(x*x+y*y));
+                            return s*std::cos(x*y+z) + s*s + e*(1.+e);
+                        },
+                        {-1., -1., -1.0}, {1.0, 1.0, 1.0}, 100,
+                        1.e-12, 1.e-15);
+
+        nerror += test3("y = x*x + z; exp(-(y+x*x)) + exp(-(y+x*x)) + if(x>0, sqrt(x*x+z*z), sqrt(x*x+z*z)+1)",
+                        {},
+                        {"x","y","z"},
+                        [=] (Real x, Real, Real z) -> Real {
+                            Real y = x*x + z;
+                            Real r = std::sqrt(x*x+z*z);
+                            return 2.*std::exp(-(y+x*x)) + ((x>0.) ? r : r+1.);
+                        },
+                        {-1., -1., -1.0}, {1.0, 1.0, 1.0}, 100,
+                        1.e-12, 1.e-15);
+
         amrex::Print() << "\nMax stack size is " << max_stack_size << "\n";
         if (nerror > 0) {
             amrex::Print() << nerror << " tests failed\n";
@@ -15,6 +15,9 @@ int num_runtime_int = 0;
 
 bool remove_negative = true;
 
+// Time spent in the Redistribute calls of one run
+Real redistribute_time = 0.0;
+
 void get_position_unit_cell(Real* r, const IntVect& nppc, int i_part)
 {
     int nx = nppc[0];
@@ -66,7 +69,9 @@ public:
         const int lev_max = finestLevel();
         const int nGrow = 0;
         const int local = 1;
+        Real t0 = amrex::second();
         Redistribute(lev_min, lev_max, nGrow, local, remove_neg);
+        redistribute_time += amrex::second() - t0;
     }
 
     void RedistributeGlobal (bool remove_neg=true)
@@ -75,7 +80,9 @@ public:
         const int lev_max = finestLevel();
         const int nGrow = 0;
         const int local = 0;
+        Real t0 = amrex::second();
         Redistribute(lev_min, lev_max, nGrow, local, remove_neg);
+        redistribute_time += amrex::second() - t0;
     }
 
     void InitParticles (const amrex::IntVect& a_num_particles_per_cell)
@@ -333,7 +340,38 @@ int main (int argc, char* argv[])
     amrex::Initialize(argc,argv);
 
     amrex::Print() << "Running redistribute test \n";
-    testRedistribute();
+
+    // Optionally run the test with both CPU implementations and compare their timings.
+    int compare_plan = 0;
+    {
+        ParmParse pp("redistribute");
+        pp.query("compare_plan", compare_plan);
+    }
+
+    if (compare_plan && Gpu::notInLaunchRegion())
+    {
+        // The copy plan is only used without tiling, so compare both that way.
+        ParmParse pp("particles");
+        pp.add("do_tiling", 0);
+
+        const bool old_plan = TestParticleContainer::planRedistribute;
+        Real times[2];
+        for (int use_plan = 0; use_plan < 2; ++use_plan)
+        {
+            TestParticleContainer::planRedistribute = use_plan;
+            redistribute_time = 0.0;
+            testRedistribute();
+            ParallelDescriptor::ReduceRealMax(redistribute_time);
+            times[use_plan] = redistribute_time;
+        }
+        TestParticleContainer::planRedistribute = old_plan;
+        amrex::Print() << "Redistribute time with the legacy CPU path: " << times[0]
+                       << " s, with the copy plan: " << times[1] << " s\n";
+    }
+    else
+    {
+        testRedistribute();
+    }
 
     amrex::Finalize();
 }
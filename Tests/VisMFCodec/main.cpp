@@ -0,0 +1,134 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Random.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_VisMFCodec.H>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace amrex;
+
+namespace {
+
+// Compress and decompress bytes, and check that we get them back.
+void check_roundtrip (const VisMFCodec& codec, const Vector<char>& data, int elem_size)
+{
+    Vector<char> compressed;
+    codec.compress(data.data(), data.size(), elem_size, compressed);
+    Vector<char> back(data.size()+1, 'x');
+    codec.decompress(compressed.data(), compressed.size(), elem_size, back.data(), data.size());
+    AMREX_ALWAYS_ASSERT(std::memcmp(back.data(), data.data(), data.size()) == 0);
+    AMREX_ALWAYS_ASSERT(back[data.size()] == 'x');
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+
+        const VisMFCodec* codec = VisMFCodec::Get("shuffle_lz");
+        AMREX_ALWAYS_ASSERT(codec != nullptr && VisMFCodec::Get("none") == nullptr);
+
+        // Short, incompressible and highly repetitive data
+        for (int n : {0, 1, 7, 8, 9, 100, 100000}) {
+            Vector<char> random(n), repeated(n);
+            for (int i = 0; i < n; ++i) {
+                random[i] = static_cast<char>(amrex::Random_int(256));
+                repeated[i] = static_cast<char>(i % 3);
+            }
+            check_roundtrip(*codec, random, 8);
+            check_roundtrip(*codec, repeated, 8);
+            check_roundtrip(*codec, repeated, 3);
+        }
+
+        BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+        MultiFab mf(ba, dm, 2, 1);
+
+        // A smooth field and a piecewise constant one, including ghost cells
+        const Real dx = 1.0_rt / n_cell;
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            auto const& a = mf.array(mfi);
+            amrex::ParallelFor(mfi.fabbox(),
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                Real x = (i+0.5_rt)*dx;
+                Real y = (j+0.5_rt)*dx;
+                a(i,j,k,0) = std::sin(2.0_rt*x) * std::cos(3.0_rt*y) + 0.1_rt*k*dx;
+                a(i,j,k,1) = (x < 0.5_rt) ? 1.0_rt : 300.0_rt;
+            });
+        }
+
+        amrex::UtilCreateDirectoryDestructive("vismfcodec");
+
+        VisMF::SetCompression("none");
+        Long bytes_plain = VisMF::Write(mf, "vismfcodec/plain");
+        VisMF::SetCompression("shuffle_lz");
+        Long bytes_lz = VisMF::Write(mf, "vismfcodec/lz");
+        VisMF::SetCompression("none");
+        ParallelDescriptor::ReduceLongSum(bytes_plain);
+        ParallelDescriptor::ReduceLongSum(bytes_lz);
+        amrex::Print() << "Bytes written without compression: " << bytes_plain
+                       << ", with shuffle_lz: " << bytes_lz
+                       << " (ratio " << Real(bytes_plain)/Real(bytes_lz) << ")\n";
+        AMREX_ALWAYS_ASSERT(bytes_lz < bytes_plain);
+
+        // The version and the codec are in the header.
+        {
+            Vector<char> hdr;
+            VisMF::ReadFAHeader("vismfcodec/lz", hdr);
+            std::string s(hdr.dataPtr());
+            AMREX_ALWAYS_ASSERT(std::atoi(s.c_str()) == VisMF::Header::Compressed_v1);
+            AMREX_ALWAYS_ASSERT(s.find("shuffle_lz") != std::string::npos);
+        }
+
+        // Read everything back.
+        for (std::string name : {"vismfcodec/plain", "vismfcodec/lz"}) {
+            MultiFab mf2;
+            VisMF::Read(mf2, name);
+            AMREX_ALWAYS_ASSERT(mf2.nGrowVect() == mf.nGrowVect());
+            MultiFab diff(ba, dm, 2, 1);
+            MultiFab::Copy(diff, mf2, 0, 0, 2, 1);
+            MultiFab::Subtract(diff, mf, 0, 0, 2, 1);
+            AMREX_ALWAYS_ASSERT(diff.norm0(0,1) == 0.0_rt && diff.norm0(1,1) == 0.0_rt);
+        }
+
+        // Read single components of individual boxes.
+        {
+            VisMF vmf("vismfcodec/lz");
+            for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                const FArrayBox& fab = vmf.GetFab(mfi.index(), 1);
+                AMREX_ALWAYS_ASSERT(fab.box() == mfi.fabbox());
+                auto const& a = mf.const_array(mfi);
+                auto const& b = fab.const_array();
+                const Box& bx = mfi.fabbox();
+                const auto lo = amrex::lbound(bx);
+                const auto hi = amrex::ubound(bx);
+                for (int k = lo.z; k <= hi.z; ++k) {
+                for (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    AMREX_ALWAYS_ASSERT(a(i,j,k,1) == b(i,j,k,0));
+                }}}
+                vmf.clear(mfi.index());
+            }
+        }
+
+        amrex::Print() << "VisMFCodec test passed\n";
+    }
+    amrex::Finalize();
+}